@@ -1,9 +1,42 @@
 #include "pch.h"
 #include "CppUnitTest.h"
 #include "cmdparse.h"
+#include <sstream>
+#include <thread>
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
+namespace
+{
+	struct point
+	{
+		int x{ 0 };
+		int y{ 0 };
+	};
+}
+
+// Converter for a user type, in the form "x,y"
+namespace WGT
+{
+	template <>
+	struct option_traits<point>
+	{
+		static convResult<point> parse(std::string_view text) {
+			auto comma = text.find(',');
+			if (comma == std::string_view::npos) {
+				return convError::invalid;
+			}
+
+			auto x = convertValue<int>(text.substr(0, comma));
+			auto y = convertValue<int>(text.substr(comma + 1));
+			if (!x || !y) {
+				return convError::invalid;
+			}
+			return point{ *x, *y };
+		}
+	};
+}
+
 namespace UnitTestcmdParse
 {
 	TEST_CLASS(UnitTestcmdParse)
@@ -178,5 +211,1184 @@ namespace UnitTestcmdParse
 			auto helpString = cmd.get_helpstring();
 		}
 
+		TEST_METHOD(GivenCompactTable_ExpectValuesClearedEachParse)
+		{
+			WGT::compactOptionTable table;
+
+			auto buffer = table.add(WGT::cmdOption("BufferSize", "1000", "b"));
+			auto output = table.add(WGT::cmdOption("OutputFile", "output.txt", "o"));
+			table.add(WGT::cmdOption("Overwrite", "", "o"));
+
+			Assert::AreEqual(3u, table.size());
+			Assert::AreEqual(static_cast<int>(output), table.find_short("o"));
+			Assert::IsTrue(table.find_short("x") == WGT::compactOptionTable::npos);
+
+			table.set_value(buffer, "23");
+			table.set_value(buffer, "4");
+			table.set_value(output, "out.txt");
+
+			auto opt = table.get_option(buffer);
+			Assert::IsTrue(opt.longName == "BufferSize");
+			Assert::IsTrue(opt.shortName == "b");
+			Assert::IsTrue(opt.defaultValue == "1000");
+			Assert::IsTrue(opt.paramValue == "4");
+
+			table.clear_values();
+			Assert::IsTrue(table.value(buffer).empty());
+			Assert::IsTrue(table.value(output).empty());
+
+			// the parser keeps its options in a table, and clears the values before each parse
+			WGT::cmdParse cmd({ { "BufferSize", "1000", "b" } });
+			const char* first[] = { "app.exe", "-b=23" };
+			const char* second[] = { "app.exe" };
+			Assert::IsTrue(cmd.init(2, first));
+			Assert::IsTrue(cmd.get_param_option("BufferSize").paramValue == "23");
+			Assert::IsTrue(cmd.init(1, second));
+			Assert::IsTrue(cmd.get_param_option("BufferSize").paramValue.empty());
+		}
+
+		TEST_METHOD(GivenCompactTable_ExpectStringsInterned)
+		{
+			WGT::stringPool pool;
+
+			auto a = pool.intern("output.txt");
+			auto b = pool.intern("input.txt");
+			auto c = pool.intern("output.txt");
+
+			Assert::IsTrue(a.offset == c.offset);
+			Assert::IsTrue(a.offset != b.offset);
+			Assert::IsTrue(pool.view(b) == "input.txt");
+			Assert::AreEqual(static_cast<size_t>(19), pool.size());
+		}
+
+		TEST_METHOD(GivenBulkOptionsWithDuplicates_ExpectAllDuplicatesReported)
+		{
+			WGT::cmdParse cmd;
+			cmd.add_param_option(WGT::cmdOption("option1", "1"));
+
+			std::vector<WGT::cmdOption> options = {
+				{ "option3", "3" }, { "OPTION1", "10" }, { "option2", "2" }, { "Option3", "30" }, { "option4", "4" }
+			};
+
+			Assert::AreEqual(3, cmd.add_param_options(std::move(options)));
+			Assert::AreEqual(4, cmd.get_param_option_count());
+			Assert::AreEqual(2, static_cast<int>(cmd.get_errors().size()));
+
+			// the first registration of a name is kept
+			Assert::IsTrue(cmd.get_param_option("option1").defaultValue == "1");
+			Assert::IsTrue(cmd.get_param_option("option3").defaultValue == "3");
+
+			const char* argv[] = { "Sample.exe", "--option4:16" };
+			cmd.clear_errors();
+			Assert::IsTrue(cmd.init(2, argv));
+			Assert::AreEqual(16, cmd.get_param_option("Option4").get_value<int>());
+		}
+
+		TEST_METHOD(GivenEmplacedOptions_ExpectOptionMatch)
+		{
+			WGT::cmdParse cmd;
+
+			Assert::IsTrue(cmd.emplace_option("BufferSize", "1000", "b"));
+			Assert::IsTrue(cmd.emplace_option("OutputFile", "output.txt"));
+			Assert::IsFalse(cmd.emplace_option("buffersize"));
+
+			WGT::cmdOption option("Verbose", "0", "v");
+			Assert::IsTrue(cmd.add_param_option(std::move(option)));
+
+			Assert::AreEqual(3, cmd.get_param_option_count());
+			Assert::AreEqual(1, static_cast<int>(cmd.get_errors().size()));
+
+			auto opt = cmd.get_param_option("OutputFile");
+			Assert::IsTrue(opt.shortName == "OutputFile");
+			Assert::IsTrue(opt.defaultValue == "output.txt");
+			Assert::IsTrue(cmd.get_param_option("verbose").shortName == "v");
+		}
+
+		TEST_METHOD(GivenReset_ExpectOptionsKeptAndValuesCleared)
+		{
+			WGT::cmdParse cmd;
+			cmd.emplace_option("option1", "1", "a");
+			cmd.emplace_option("option2", "2", "b");
+
+			const char* argv1[] = { "Sample.exe", "--option1:16", "--NotAnOption=3" };
+			Assert::IsFalse(cmd.init(3, argv1));
+			Assert::IsTrue(cmd.has_errors());
+
+			cmd.reset();
+			Assert::IsFalse(cmd.has_errors());
+			Assert::AreEqual(2, cmd.get_param_option_count());
+			Assert::IsTrue(cmd.get_param_option("option1").paramValue.empty());
+
+			const char* argv2[] = { "Sample.exe", "-b:7" };
+			Assert::IsTrue(cmd.init(2, argv2));
+			Assert::AreEqual(1, static_cast<int>(cmd.get_arguments().size()));
+			Assert::AreEqual(7, cmd.get_param_option("option2").get_value<int>());
+		}
+
+		TEST_METHOD(GivenFrozenOptions_ExpectLookupAndNoMoreOptions)
+		{
+			WGT::cmdParse cmd;
+			for (int n = 0; n < 500; n++) {
+				cmd.emplace_option("option" + std::to_string(n), std::to_string(n), "o" + std::to_string(n));
+			}
+
+			Assert::IsTrue(cmd.freeze());
+			Assert::IsTrue(cmd.is_frozen());
+
+			Assert::IsFalse(cmd.emplace_option("optionX"));
+			Assert::IsTrue(cmd.has_errors());
+			Assert::AreEqual(500, cmd.get_param_option_count());
+			cmd.clear_errors();
+
+			for (int n = 0; n < 500; n++) {
+				Assert::IsTrue(cmd.has_param_option("OPTION" + std::to_string(n)));
+			}
+			Assert::IsFalse(cmd.has_param_option("option500"));
+			Assert::IsFalse(cmd.has_param_option("o1"));
+
+			const char* argv[] = { "Sample.exe", "--Option12:16", "-o499=7" };
+			Assert::IsTrue(cmd.init(3, argv));
+			Assert::AreEqual(16, cmd.get_param_option("option12").get_value<int>());
+			Assert::AreEqual(7, cmd.get_param_option("option499").get_value<int>());
+		}
+
+		TEST_METHOD(GivenFrozenOptionsWithSharedShortName_ExpectFirstUsed)
+		{
+			WGT::cmdParse cmd;
+			cmd.emplace_option("alpha", "1", "a");
+			cmd.emplace_option("another", "2", "a");
+
+			Assert::IsFalse(cmd.freeze());
+			Assert::IsTrue(cmd.is_frozen());
+
+			const char* argv[] = { "Sample.exe", "-a:5" };
+			Assert::IsTrue(cmd.init(2, argv));
+			Assert::IsTrue(cmd.get_param_option("alpha").paramValue == "5");
+			Assert::IsTrue(cmd.get_param_option("another").paramValue.empty());
+		}
+
+		TEST_METHOD(GivenCaseSensitivePolicy_ExpectExactNameMatch)
+		{
+			using strictParse = WGT::basicCmdParse<WGT::matchCase, WGT::cmdSyntax<'\0', '='>, WGT::ignoreErrors>;
+
+			strictParse cmd;
+			Assert::IsTrue(cmd.emplace_option("BufferSize", "1000", "b"));
+			Assert::IsTrue(cmd.emplace_option("buffersize", "10"));
+			Assert::AreEqual(2, cmd.get_param_option_count());
+
+			const char* argv[] = { "Sample.exe", "--BufferSize=\"23\"", "-buffersize=7" };
+			Assert::IsTrue(cmd.init(3, argv));
+			Assert::IsTrue(cmd.get_param_option("BufferSize").paramValue == "\"23\"");
+			Assert::IsTrue(cmd.get_param_option("buffersize").paramValue == "7");
+			Assert::IsFalse(cmd.has_param_option("BUFFERSIZE"));
+
+			// ':' is not a separator, so this is an unknown option; no error text is kept
+			const char* argv2[] = { "Sample.exe", "--BufferSize:1" };
+			cmd.reset();
+			Assert::IsFalse(cmd.init(2, argv2));
+			Assert::IsFalse(cmd.has_errors());
+		}
+
+		TEST_METHOD(GivenListOption_ExpectConvertedElements)
+		{
+			WGT::cmdParse cmd;
+			Assert::IsTrue(cmd.add_list_option<double>("weights", "1,2", "w"));
+			Assert::IsTrue(cmd.add_list_option<int>("sizes", "", "s", ';'));
+
+			// default value until parsed
+			auto defaults = cmd.get_list<double>("weights");
+			Assert::AreEqual(static_cast<size_t>(2), defaults.size);
+
+			const char* argv[] = { "Sample.exe", "--weights=0.1, 0.25,3e2", "-s:1;-2;+3" };
+			Assert::IsTrue(cmd.init(3, argv));
+
+			auto weights = cmd.get_list<double>("weights");
+			Assert::AreEqual(static_cast<size_t>(3), weights.size);
+			Assert::AreEqual(0.25, weights[1]);
+			Assert::AreEqual(300.0, weights[2]);
+
+			auto sizes = cmd.get_list<int>("sizes");
+			Assert::AreEqual(static_cast<size_t>(3), sizes.size);
+			Assert::AreEqual(-2, sizes[1]);
+			Assert::AreEqual(3, sizes[2]);
+
+			// wrong element type
+			Assert::IsTrue(cmd.get_list<int>("weights").empty());
+			Assert::IsTrue(cmd.get_list<unsigned int>("sizes").empty());
+			Assert::IsTrue(cmd.get_list<float>("sizes").empty());
+		}
+
+		TEST_METHOD(GivenInvalidListElement_ExpectErrorWithPosition)
+		{
+			WGT::cmdParse cmd;
+			cmd.add_list_option<int>("ids", "", "i");
+
+			const char* argv[] = { "Sample.exe", "--ids=10,20,x3,40" };
+			Assert::IsFalse(cmd.init(2, argv));
+
+			auto errors = cmd.get_errors();
+			Assert::AreEqual(1, static_cast<int>(errors.size()));
+			Assert::IsTrue(errors[0].find("ids[2] at offset 6") != std::string::npos);
+			Assert::IsTrue(cmd.get_list<int>("ids").empty());
+		}
+
+		TEST_METHOD(GivenRepeatedOptions_ExpectRepeatPolicyApplied)
+		{
+			WGT::cmdParse cmd;
+			cmd.emplace_option("include", "", "I");
+			cmd.emplace_option("first", "", "f");
+			cmd.emplace_option("last", "", "l");
+			Assert::IsTrue(cmd.set_repeat_policy("include", WGT::repeatPolicy::accumulate));
+			Assert::IsTrue(cmd.set_repeat_policy("first", WGT::repeatPolicy::firstWins));
+			Assert::IsFalse(cmd.set_repeat_policy("NotAnOption", WGT::repeatPolicy::firstWins));
+
+			const char* argv[] = { "Sample.exe", "-I:a", "--first=1", "-I:b", "-l:1", "--first=2", "-I:c", "-l:2" };
+			Assert::IsTrue(cmd.init(8, argv));
+
+			auto includes = cmd.get_values("include");
+			Assert::AreEqual(3, static_cast<int>(includes.size()));
+			Assert::IsTrue(includes[0] == "a");
+			Assert::IsTrue(includes[2] == "c");
+			Assert::AreEqual(3, cmd.get_occurrence_count("include"));
+
+			Assert::IsTrue(cmd.get_param_option("first").paramValue == "1");
+			Assert::IsTrue(cmd.get_param_option("last").paramValue == "2");
+			Assert::AreEqual(2, cmd.get_occurrence_count("last"));
+			Assert::AreEqual(0, static_cast<int>(cmd.get_values("last").size()));
+
+			// counts do not stop at 255, and each option's values are kept apart
+			cmd.emplace_option("exclude", "", "X");
+			cmd.set_repeat_policy("exclude", WGT::repeatPolicy::accumulate);
+			std::vector<std::string> many{ "Sample.exe" };
+			for (int n = 0; n < 300; n++) {
+				many.push_back("-I:" + std::to_string(n));
+				many.push_back("-X:" + std::to_string(n * 2));
+			}
+			std::vector<const char*> manyArgv;
+			for (auto& arg : many) {
+				manyArgv.push_back(arg.c_str());
+			}
+			Assert::IsTrue(cmd.init(static_cast<int>(manyArgv.size()), manyArgv.data()));
+			Assert::AreEqual(300, cmd.get_occurrence_count("include"));
+			includes = cmd.get_values("include");
+			auto excludes = cmd.get_values("exclude");
+			Assert::AreEqual(static_cast<size_t>(300), includes.size());
+			Assert::IsTrue((includes[299] == "299") && (excludes[299] == "598"));
+
+			std::vector<uint32_t> snapshot(cmd.write_snapshot(nullptr, 0) / sizeof(uint32_t) + 1);
+			cmd.write_snapshot(snapshot.data(), snapshot.size() * sizeof(uint32_t));
+			Assert::AreEqual(300, WGT::cmdSnapshot(snapshot.data(), snapshot.size() * sizeof(uint32_t)).get_occurrence_count("exclude"));
+		}
+
+		TEST_METHOD(GivenMapOption_ExpectKeyValueEntries)
+		{
+			WGT::cmdParse cmd;
+			Assert::IsTrue(cmd.add_map_option("define", "D"));
+			cmd.emplace_option("debug", "0", "d");
+
+			const char* argv[] = { "Sample.exe", "-DNAME=value", "-D:OTHER=2", "--define=LAST:x", "-DNAME=again", "-DFLAG", "-d:1" };
+			Assert::IsTrue(cmd.init(7, argv));
+
+			Assert::IsTrue(cmd.get_map_value("define", "NAME").value() == "again");
+			Assert::IsTrue(cmd.get_map_value("define", "OTHER").value() == "2");
+			Assert::IsTrue(cmd.get_map_value("define", "LAST").value() == "x");
+			Assert::IsTrue(cmd.get_map_value("define", "FLAG").value().empty());
+			Assert::IsFalse(cmd.get_map_value("define", "name").has_value());
+			Assert::AreEqual(4, static_cast<int>(cmd.get_map_entries("define").size()));
+			Assert::IsTrue(cmd.get_param_option("debug").paramValue == "1");
+
+			// the values of a single argument are read from argv, not copied
+			Assert::IsTrue(cmd.get_map_value("define", "NAME").value().data() == argv[4] + 7);
+
+			// the longest short name that prefixes the argument is used
+			Assert::IsTrue(cmd.add_map_option("property", "DP"));
+			const char* longer[] = { "Sample.exe", "-DPNAME=1", "-DNAME=2", "--define", "=KEY=3" };
+			Assert::IsTrue(cmd.init(5, longer));
+			Assert::IsTrue(cmd.get_map_value("property", "NAME").value() == "1");
+			Assert::IsTrue(cmd.get_map_value("define", "NAME").value() == "2");
+			Assert::IsTrue(cmd.get_map_value("define", "KEY").value() == "3");
+		}
+
+		TEST_METHOD(GivenFlagOptions_ExpectPresenceAndCounts)
+		{
+			WGT::cmdParse cmd;
+			cmd.add_flag_option("extract", "x");
+			cmd.add_flag_option("verbose", "v");
+			cmd.add_flag_option("force", "f");
+			cmd.add_flag_option("quiet", "q");
+			cmd.add_flag_option("colour");
+			cmd.emplace_option("level", "0", "l");
+
+			const char* argv[] = { "Sample.exe", "-xvf", "-vv", "--colour=no", "-l:2" };
+			Assert::IsTrue(cmd.init(5, argv));
+
+			auto verbose = cmd.get_option_id("verbose");
+			Assert::IsTrue(cmd.is_flag_set(verbose));
+			Assert::AreEqual(3, cmd.get_flag_count("verbose"));
+			Assert::IsTrue(cmd.is_flag_set("extract"));
+			Assert::IsTrue(cmd.is_flag_set("force"));
+			Assert::IsFalse(cmd.is_flag_set("quiet"));
+			Assert::IsFalse(cmd.is_flag_set("colour"));
+			Assert::IsTrue(cmd.get_param_option("level").has_value());
+			Assert::IsFalse(cmd.get_param_option("verbose").has_value());
+
+			// not every letter is a flag
+			const char* argv2[] = { "Sample.exe", "-xl" };
+			cmd.reset();
+			Assert::IsFalse(cmd.init(2, argv2));
+		}
+
+		TEST_METHOD(GivenBooleanStrings_ExpectConversion)
+		{
+			bool value = false;
+			Assert::IsTrue(WGT::string_utils::is_boolean(std::string_view(" Yes "), value));
+			Assert::IsTrue(value);
+			Assert::IsTrue(WGT::string_utils::is_boolean(std::string_view("FALSE"), value));
+			Assert::IsFalse(value);
+			Assert::IsFalse(WGT::string_utils::is_boolean(std::string_view("maybe"), value));
+		}
+
+		TEST_METHOD(GivenParseErrors_ExpectStructuredRecords)
+		{
+			WGT::cmdParse cmd;
+			cmd.add_list_option<int>("ids", "", "i");
+			cmd.emplace_option("ids");
+
+			const char* argv[] = { "Sample.exe", "--ids=1,x", "--missing=3" };
+			Assert::IsFalse(cmd.init(3, argv));
+
+			auto& records = cmd.get_error_records();
+			Assert::AreEqual(2, static_cast<int>(records.size()));
+
+			Assert::IsTrue(records[0].code == WGT::errorCode::optionExists);
+			Assert::IsTrue(records[0].argIndex == -1);
+			Assert::IsTrue(cmd.get_error_text(records[0]) == "ids");
+
+			Assert::IsTrue(records[1].code == WGT::errorCode::invalidListElement);
+			Assert::AreEqual(1, records[1].argIndex);
+			Assert::AreEqual(cmd.get_option_id("ids"), records[1].optionId);
+			Assert::AreEqual(1u, records[1].index);
+			Assert::IsTrue(cmd.get_error_text(records[1]) == "x");
+
+			Assert::IsTrue(cmd.format_error(records[0]) == "Option already exists: ids");
+			Assert::IsTrue(cmd.get_errors()[1] == "Invalid list element: ids[1] at offset 2: \"x\"");
+
+			cmd.clear_errors();
+			Assert::IsFalse(cmd.has_errors());
+		}
+
+		TEST_METHOD(GivenInvalidValues_ExpectTryGetErrorsWithoutThrowing)
+		{
+			WGT::cmdParse cmd;
+			cmd.emplace_option("size", "64", "s");
+			cmd.emplace_option("ratio", "", "r");
+			cmd.emplace_option("count", "", "c");
+			cmd.emplace_option("enabled", "", "e");
+
+			const char* argv[] = { "Sample.exe", "--ratio=abc", "--count=99999999999", "--enabled=yes" };
+			Assert::IsTrue(cmd.init(4, argv));
+
+			// not given, so the default is converted
+			auto size = cmd.try_get<int>("size");
+			Assert::IsTrue(size.has_value());
+			Assert::AreEqual(64, *size);
+
+			Assert::IsTrue(cmd.try_get<double>("ratio").error() == WGT::convError::invalid);
+			Assert::IsTrue(cmd.try_get<int>("count").error() == WGT::convError::outOfRange);
+			Assert::AreEqual(99999999999ll, cmd.try_get<long long>("count").value());
+			Assert::IsTrue(cmd.try_get<bool>("enabled").value());
+			Assert::IsTrue(cmd.try_get<int>("missing").error() == WGT::convError::unknownOption);
+
+			auto ratio = cmd.get_param_option("ratio").try_get<double>();
+			Assert::IsFalse(static_cast<bool>(ratio));
+			Assert::AreEqual(1.5, ratio.value_or(1.5));
+		}
+
+
+		TEST_METHOD(GivenTypedValues_ExpectOptionTraitsConversions)
+		{
+			using namespace std::chrono_literals;
+
+			WGT::cmdParse cmd;
+			cmd.emplace_option("timeout", "5s", "t");
+			cmd.emplace_option("poll", "", "p");
+			cmd.emplace_option("cache", "", "c");
+			cmd.emplace_option("limit", "", "l");
+			cmd.emplace_option("origin", "", "o");
+			cmd.add_list_option<std::chrono::milliseconds>("delays", "", "d");
+
+			const char* argv[] = { "Sample.exe", "--poll=250ms", "--cache=64KiB", "--limit=200", "--origin=3,-4", "--delays=1s,20ms, 1.5s" };
+			Assert::IsTrue(cmd.init(6, argv));
+
+			// integers of every width, checked against their range
+			Assert::AreEqual(200, static_cast<int>(cmd.try_get<uint8_t>("limit").value()));
+			Assert::IsTrue(cmd.try_get<int8_t>("limit").error() == WGT::convError::outOfRange);
+			Assert::AreEqual(200ull, cmd.try_get<unsigned long long>("limit").value());
+			Assert::AreEqual(200.0f, cmd.try_get<float>("limit").value());
+
+			// durations, in any units
+			Assert::IsTrue(cmd.try_get<std::chrono::milliseconds>("poll").value() == 250ms);
+			Assert::IsTrue(cmd.try_get<std::chrono::microseconds>("poll").value() == 250000us);
+			Assert::IsTrue(cmd.try_get<std::chrono::seconds>("timeout").value() == 5s);
+			Assert::IsTrue(cmd.try_get<std::chrono::seconds>("cache").error() == WGT::convError::invalid);
+			Assert::IsTrue(WGT::convertValue<std::chrono::duration<double>>("1.5m").value().count() == 90.0);
+			Assert::IsTrue(WGT::convertValue<std::chrono::seconds>("2h").value() == 7200s);
+			Assert::IsTrue(WGT::convertValue<std::chrono::seconds>("30").value() == 30s);
+
+			// byte sizes
+			Assert::AreEqual(65536ull, static_cast<unsigned long long>(cmd.try_get<WGT::byteSize>("cache").value()));
+			Assert::AreEqual(2147483648ull, static_cast<unsigned long long>(WGT::convertValue<WGT::byteSize>("2G").value()));
+			Assert::AreEqual(2000000000ull, static_cast<unsigned long long>(WGT::convertValue<WGT::byteSize>("2GB").value()));
+			Assert::AreEqual(1536ull, static_cast<unsigned long long>(WGT::convertValue<WGT::byteSize>("1.5k").value()));
+			Assert::IsTrue(WGT::convertValue<WGT::byteSize>("64XB").error() == WGT::convError::invalid);
+			Assert::IsTrue(WGT::convertValue<WGT::byteSize>("32E").error() == WGT::convError::outOfRange);
+
+			// user converter
+			auto origin = cmd.try_get<point>("origin");
+			Assert::IsTrue(origin.has_value());
+			Assert::AreEqual(3, origin->x);
+			Assert::AreEqual(-4, origin->y);
+
+			// lists of any converted type
+			auto delays = cmd.get_list<std::chrono::milliseconds>("delays");
+			Assert::AreEqual(static_cast<size_t>(3), delays.size);
+			Assert::IsTrue(delays[1] == 20ms);
+			Assert::IsTrue(delays[2] == 1500ms);
+
+			// get_value() throws if the value cannot be converted
+			Assert::AreEqual(std::string("3,-4"), cmd.get_param_option("origin").get_value<std::string>());
+			Assert::ExpectException<std::invalid_argument>([&]() { cmd.get_param_option("origin").get_value<int>(); });
+			Assert::ExpectException<std::out_of_range>([&]() { cmd.get_param_option("limit").get_value<int8_t>(); });
+		}
+
+
+		TEST_METHOD(GivenDescriptions_ExpectWrappedCachedHelp)
+		{
+			WGT::cmdParse cmd;
+			cmd.emplace_option("BufferSize", "1000", "b");
+			cmd.emplace_option("OutputFile", "", "o");
+			Assert::IsTrue(cmd.set_description("BufferSize", "Size of the buffer used to read each input file, in bytes."));
+			Assert::IsFalse(cmd.set_description("missing", "text"));
+			Assert::IsTrue(cmd.get_description("buffersize") == "Size of the buffer used to read each input file, in bytes.");
+
+			const char* argv[] = { "Sample.exe" };
+			cmd.init(1, argv);
+
+			auto help = cmd.get_helpstring(60);
+			Assert::IsTrue(help.find("    -b, --BufferSize  Size of the buffer used to read each\n") != std::string::npos);
+			Assert::IsTrue(help.find("\n                      input file, in bytes. Default: 1000\n") != std::string::npos);
+			Assert::IsTrue(help.find("    -o, --OutputFile\n") != std::string::npos);
+
+			// no line is wider than asked for
+			size_t lineStart = 0;
+			for (size_t end = help.find('\n'); end != std::string::npos; end = help.find('\n', lineStart)) {
+				Assert::IsTrue(end - lineStart <= 60);
+				lineStart = end + 1;
+			}
+
+			// built once, until an option is added
+			Assert::IsTrue(cmd.get_helpstring(60) == help);
+			cmd.emplace_option("Verbose", "", "v");
+			Assert::IsTrue(cmd.get_helpstring(60).find("--Verbose") != std::string::npos);
+
+			std::ostringstream stream;
+			cmd.write_help(stream, 60);
+			Assert::IsTrue(stream.str() == cmd.get_helpstring(60) + "\n");
+
+			// and to a file descriptor
+			std::FILE* file = std::tmpfile();
+#ifdef _WIN32
+			Assert::IsTrue(cmd.write_help(_fileno(file), 60));
+#else
+			Assert::IsTrue(cmd.write_help(fileno(file), 60));
+#endif
+			std::rewind(file);
+			std::string written(stream.str().size() + 1, '\0');
+			written.resize(std::fread(&written[0], 1, written.size(), file));
+			std::fclose(file);
+			Assert::IsTrue(written == stream.str());
+
+			// a const parser can be asked for help from several threads, at different widths
+			const auto& shared = cmd;
+			const auto wide = shared.get_helpstring(100);
+			help = shared.get_helpstring(60);
+			std::atomic<int> wrong{ 0 };
+			std::vector<std::thread> threads;
+			for (int t = 0; t < 4; t++) {
+				threads.emplace_back([&, t] {
+					for (int n = 0; n < 200; n++) {
+						if (shared.get_helpstring(((t + n) % 2) ? 60 : 100) != (((t + n) % 2) ? help : wide)) {
+							wrong++;
+						}
+					}
+				});
+			}
+			for (auto& thread : threads) {
+				thread.join();
+			}
+			Assert::AreEqual(0, wrong.load());
+		}
+
+
+		TEST_METHOD(GivenHelpTerm_ExpectOnlyMatchingOptions)
+		{
+			WGT::cmdParse cmd;
+			for (int n = 0; n < 500; n++) {
+				cmd.emplace_option("option" + std::to_string(n), "", "o" + std::to_string(n));
+			}
+			cmd.emplace_option("BufferSize", "1000", "b");
+			cmd.emplace_option("OutputFile", "", "o");
+			cmd.set_description("OutputFile", "Where to write the results");
+
+			// names and descriptions, in any case
+			auto ids = cmd.find_options("BUFFER");
+			Assert::AreEqual(static_cast<size_t>(1), ids.size());
+			Assert::AreEqual(cmd.get_option_id("BufferSize"), static_cast<int>(ids[0]));
+			Assert::AreEqual(static_cast<size_t>(1), cmd.find_options("write the").size());
+			Assert::AreEqual(static_cast<size_t>(0), cmd.find_options("ezi").size());
+			Assert::AreEqual(static_cast<size_t>(11), cmd.find_options("option49").size());
+			Assert::AreEqual(static_cast<size_t>(502), cmd.find_options("").size());
+
+			// short terms, in order of name
+			ids = cmd.find_options("ut");
+			Assert::AreEqual(static_cast<size_t>(1), ids.size());
+			ids = cmd.find_options("e");
+			Assert::AreEqual(static_cast<size_t>(2), ids.size());
+			Assert::AreEqual(cmd.get_option_id("BufferSize"), static_cast<int>(ids[0]));
+
+			// the index is rebuilt for new options
+			cmd.emplace_option("BufferCount", "", "c");
+			Assert::AreEqual(static_cast<size_t>(2), cmd.find_options("buffer").size());
+
+			auto help = cmd.get_helpstring("results", 80);
+			Assert::IsTrue(help.find("--OutputFile") != std::string::npos);
+			Assert::IsTrue(help.find("--BufferSize") == std::string::npos);
+
+			// the first searches of a new index may come from several threads at once
+			cmd.emplace_option("Threads", "", "t");
+			const auto& shared = cmd;
+			std::atomic<int> wrong{ 0 };
+			std::vector<std::thread> threads;
+			for (int t = 0; t < 4; t++) {
+				threads.emplace_back([&] {
+					if ((shared.find_options("buffer").size() != 2) || (shared.find_options("threads").size() != 1)) {
+						wrong++;
+					}
+				});
+			}
+			for (auto& thread : threads) {
+				thread.join();
+			}
+			Assert::AreEqual(0, wrong.load());
+		}
+
+
+		TEST_METHOD(GivenSubcommands_ExpectOnlyUsedOneConstructed)
+		{
+			WGT::cmdParse cmd;
+			cmd.emplace_option("verbose", "", "v");
+
+			int setupCount = 0;
+			for (int n = 0; n < 60; n++) {
+				Assert::IsTrue(cmd.add_subcommand("command" + std::to_string(n), [&setupCount](WGT::cmdParse& sub) {
+					setupCount++;
+					sub.emplace_option("depth", "0", "d");
+				}));
+			}
+			Assert::IsTrue(cmd.add_subcommand("clone", [&setupCount](WGT::cmdParse& sub) {
+				setupCount++;
+				sub.emplace_option("depth", "0", "d");
+				sub.emplace_option("branch", "main", "b");
+			}));
+			Assert::IsFalse(cmd.add_subcommand("Clone", nullptr));
+			Assert::IsTrue(cmd.has_errors());
+			cmd.clear_errors();
+
+			const char* argv[] = { "Sample.exe", "--verbose=1", "CLONE", "--depth=3", "-b:dev" };
+			Assert::IsTrue(cmd.init(5, argv));
+			Assert::AreEqual(1, setupCount);
+			Assert::IsTrue(cmd.get_subcommand_name() == "clone");
+			Assert::AreEqual(std::string("1"), cmd.get_param_option("verbose").paramValue);
+			Assert::IsFalse(cmd.has_param_option("depth"));
+
+			auto clone = cmd.get_subcommand();
+			Assert::IsNotNull(clone);
+			Assert::AreEqual(3, clone->try_get<int>("depth").value());
+			Assert::AreEqual(std::string("dev"), clone->get_param_option("branch").paramValue);
+
+			// the subcommand's parser is kept for the next command-line
+			cmd.reset();
+			Assert::IsNull(cmd.get_subcommand());
+			const char* argv2[] = { "Sample.exe", "clone" };
+			Assert::IsTrue(cmd.init(2, argv2));
+			Assert::AreEqual(1, setupCount);
+			Assert::AreEqual(0, cmd.get_subcommand()->try_get<int>("depth").value());
+
+			// options of the subcommand are not options of the application
+			cmd.reset();
+			const char* argv3[] = { "Sample.exe", "command7", "--branch=x" };
+			Assert::IsFalse(cmd.init(3, argv3));
+			Assert::AreEqual(2, setupCount);
+			Assert::IsTrue(cmd.get_subcommand()->has_errors());
+
+			cmd.reset();
+			const char* argv4[] = { "Sample.exe", "push" };
+			Assert::IsFalse(cmd.init(2, argv4));
+			Assert::IsTrue(cmd.get_error_records()[0].code == WGT::errorCode::subcommandNotFound);
+			Assert::AreEqual(1, cmd.get_error_records()[0].argIndex);
+		}
+
+
+		TEST_METHOD(GivenPositionalsAndTerminator_ExpectViewsIntoArgv)
+		{
+			WGT::cmdParse cmd;
+			cmd.emplace_option("OutputFile", "", "o");
+			cmd.emplace_option("BufferSize", "", "b");
+
+			const char* argv[] = { "Sample.exe", "input1.txt", "--OutputFile", "=out.txt", "-", "-b:4", "input2.txt", "--", "child.exe", "--OutputFile=x", nullptr };
+			Assert::IsTrue(cmd.init(10, argv));
+
+			// values can still continue in the next argument
+			Assert::AreEqual(std::string("out.txt"), cmd.get_param_option("OutputFile").paramValue);
+			Assert::AreEqual(std::string("4"), cmd.get_param_option("BufferSize").paramValue);
+
+			auto& positionals = cmd.get_positionals();
+			Assert::AreEqual(static_cast<size_t>(3), positionals.size());
+			Assert::IsTrue(positionals[0] == "input1.txt");
+			Assert::IsTrue(positionals[1] == "-");
+			Assert::IsTrue(positionals[2].data() == argv[6]);
+
+			// the rest is not parsed, and is null-terminated like argv
+			auto child = cmd.get_passthrough();
+			Assert::AreEqual(static_cast<size_t>(2), child.size);
+			Assert::IsTrue(child.data == argv + 8);
+			Assert::IsNull(child.data[child.size]);
+
+			cmd.reset();
+			const char* argv2[] = { "Sample.exe", "--OutputFile=y" };
+			Assert::IsTrue(cmd.init(2, argv2));
+			Assert::IsTrue(cmd.get_positionals().empty());
+			Assert::IsNull(cmd.get_passthrough().data);
+		}
+
+
+		TEST_METHOD(GivenUnknownPassthrough_ExpectForwardArgv)
+		{
+			WGT::cmdParse cmd;
+			cmd.emplace_option("wrapperLog", "", "w");
+			cmd.add_flag_option("verbose", "v");
+			cmd.set_unknown_passthrough();
+
+			const char* argv[] = { "wrapper.exe", "--childOption", "=3", "-w:log.txt", "-c", "file.txt", "-v", "--other:x", "--", "--last", nullptr };
+			Assert::IsTrue(cmd.init(10, argv));
+			Assert::IsFalse(cmd.has_errors());
+			Assert::AreEqual(std::string("log.txt"), cmd.get_param_option("wrapperLog").paramValue);
+			Assert::IsTrue(cmd.is_flag_set("verbose"));
+
+			auto& unknown = cmd.get_unknown_options();
+			Assert::AreEqual(static_cast<size_t>(4), unknown.size());
+			Assert::IsTrue(unknown[0] == "--childOption");
+			Assert::IsTrue(unknown[1] == "=3");
+			Assert::IsTrue(unknown[3].data() == argv[7]);
+
+			auto args = cmd.get_forward_argv("child.exe");
+			Assert::AreEqual(static_cast<size_t>(8), args.size());
+			const char* expected[] = { "child.exe", "--childOption", "=3", "-c", "file.txt", "--other:x", "--last" };
+			for (size_t n = 0; n < 7; n++) {
+				Assert::AreEqual(std::string(expected[n]), std::string(args[n]));
+			}
+			Assert::IsNull(args[7]);
+
+			// a second command-line forwards only its own arguments
+			const char* argv2[] = { "wrapper.exe", "--child2", "two.txt" };
+			Assert::IsTrue(cmd.init(3, argv2));
+			Assert::AreEqual(static_cast<size_t>(1), cmd.get_unknown_options().size());
+			Assert::IsTrue(cmd.get_unknown_options()[0].data() == argv2[1]);
+			auto args2 = cmd.get_forward_argv();
+			Assert::AreEqual(static_cast<size_t>(3), args2.size());
+			Assert::IsTrue((args2[0] == argv2[1]) && (args2[1] == argv2[2]));
+
+			// without passthrough, unknown options are errors
+			WGT::cmdParse strict;
+			strict.emplace_option("wrapperLog", "", "w");
+			Assert::IsFalse(strict.init(3, argv));
+			Assert::IsTrue(strict.get_unknown_options().empty());
+		}
+
+
+		TEST_METHOD(GivenParsedOptions_ExpectEquivalentArgvWritten)
+		{
+			WGT::cmdParse cmd;
+			cmd.emplace_option("BufferSize", "1000", "b");
+			cmd.emplace_option("Title", "", "t");
+			cmd.emplace_option("include", "", "I");
+			cmd.set_repeat_policy("include", WGT::repeatPolicy::accumulate);
+			cmd.add_map_option("define", "D");
+			cmd.add_flag_option("verbose", "v");
+			cmd.emplace_option("unused", "x", "u");
+
+			const char* argv[] = { "Sample.exe", "--BufferSize:23", "--Title=\" a b \"", "-I:x", "-I:y", "-DNAME=1", "-vv", "in.txt", "--", "rest" };
+			Assert::IsTrue(cmd.init(10, argv));
+
+			// too small: only the size is returned
+			auto needed = cmd.write_argv(nullptr, 0);
+			Assert::IsNull(needed.argv);
+			Assert::AreEqual(11, needed.argc);
+
+			std::vector<char> buffer(needed.size);
+			auto args = cmd.write_argv(buffer.data(), buffer.size());
+			Assert::IsNotNull(args.argv);
+			const char* expected[] = { "Sample.exe", "--BufferSize=23", "--Title=\" a b \"", "--include=x", "--include=y", "--define=NAME=1", "--verbose", "--verbose", "in.txt", "--", "rest" };
+			for (int n = 0; n < args.argc; n++) {
+				Assert::AreEqual(std::string(expected[n]), std::string(args.argv[n]));
+				Assert::IsTrue((args.argv[n] >= buffer.data()) && (args.argv[n] < buffer.data() + buffer.size()));
+			}
+			Assert::IsNull(args.argv[args.argc]);
+
+			// the written arguments parse to the same values
+			WGT::cmdParse copy;
+			copy.emplace_option("BufferSize", "1000", "b");
+			copy.emplace_option("Title", "", "t");
+			copy.emplace_option("include", "", "I");
+			copy.set_repeat_policy("include", WGT::repeatPolicy::accumulate);
+			copy.add_map_option("define", "D");
+			copy.add_flag_option("verbose", "v");
+			copy.emplace_option("unused", "x", "u");
+			Assert::IsTrue(copy.init(args.argc, const_cast<const char**>(args.argv)));
+			Assert::AreEqual(std::string(" a b "), copy.get_param_option("Title").paramValue);
+			Assert::AreEqual(2, copy.get_flag_count("verbose"));
+			Assert::AreEqual(static_cast<size_t>(2), copy.get_values("include").size());
+			Assert::IsTrue(copy.get_map_value("define", "NAME").value() == "1");
+
+			// short names, another separator, and the options that were not given
+			WGT::argvStyle style;
+			style.shortNames = true;
+			style.separator = ':';
+			style.allOptions = true;
+			std::vector<char> shortBuffer(cmd.write_argv(nullptr, 0, style, "child.exe").size);
+			auto shortArgs = cmd.write_argv(shortBuffer.data(), shortBuffer.size(), style, "child.exe");
+			Assert::AreEqual(std::string("child.exe"), std::string(shortArgs.argv[0]));
+			Assert::AreEqual(std::string("-b:23"), std::string(shortArgs.argv[1]));
+			Assert::AreEqual(std::string("-u:x"), std::string(shortArgs.argv[8]));
+
+			// joined into one command-line, with quotes and backslashes in the values
+			const char* quotedArgv[] = { "C:\\My Apps\\Sample.exe", "--Title=\" say \"hi\" \"", "-I:a\\\"b", "C:\\My Files\\", "" };
+			Assert::IsTrue(cmd.init(5, quotedArgv));
+			style = {};
+			style.quoteSpaces = true;
+			std::vector<char> joinBuffer(cmd.write_argv(nullptr, 0, style).size);
+			auto joinArgs = cmd.write_argv(joinBuffer.data(), joinBuffer.size(), style);
+			std::string line;
+			for (int n = 0; n < joinArgs.argc; n++) {
+				line += (n == 0) ? "" : " ";
+				line += joinArgs.argv[n];
+			}
+			Assert::AreEqual(std::string(R"("C:\My Apps\Sample.exe" "--Title=\" say \"hi\" \"" "--include=a\\\"b" "C:\My Files\\" "")"), line);
+			Assert::IsTrue(copy.init_from_string(line));
+			Assert::AreEqual(std::string(" say \"hi\" "), copy.get_param_option("Title").paramValue);
+			Assert::AreEqual(std::string("a\\\"b"), std::string(copy.get_values("include")[0]));
+			Assert::AreEqual(std::string("C:\\My Files\\"), std::string(copy.get_positionals()[0]));
+			Assert::AreEqual(std::string(""), std::string(copy.get_positionals()[1]));
+
+			// a value that begins or ends with a quote would be stripped, so it is not written
+			WGT::cmdParse quoted;
+			quoted.emplace_option("Title", "\"x\"", "t");
+			Assert::IsTrue(quoted.init(1, argv));
+			style.allOptions = true;
+			std::vector<char> quotedBuffer(quoted.write_argv(nullptr, 0, style).size);
+			auto quotedArgs = quoted.write_argv(quotedBuffer.data(), quotedBuffer.size(), style);
+			Assert::IsNull(quotedArgs.argv);
+			Assert::IsTrue(quotedArgs.unreadable == "Title");
+		}
+
+
+		TEST_METHOD(GivenSnapshot_ExpectQueriesInPlaceAnywhere)
+		{
+			const char* argv[] = { "Sample.exe", "--BufferSize=23", "-t=Hello", "in.txt", "-v", "out.txt" };
+			WGT::cmdParse cmd;
+			cmd.emplace_option("BufferSize", "1000", "b");
+			cmd.emplace_option("Title", "", "t");
+			cmd.emplace_option("Mode", "fast", "m");
+			cmd.add_flag_option("verbose", "v");
+			Assert::IsTrue(cmd.init(6, argv));
+
+			// too small a buffer is left alone
+			const size_t size = cmd.write_snapshot(nullptr, 0);
+			std::vector<uint32_t> first(size / sizeof(uint32_t) + 1, 0);
+			Assert::AreEqual(size, cmd.write_snapshot(first.data(), size - 1));
+			Assert::AreEqual(0u, first[0]);
+			Assert::AreEqual(size, cmd.write_snapshot(first.data(), size));
+
+			// move it somewhere else, as another process would see it
+			std::vector<uint32_t> moved(first);
+			std::fill(first.begin(), first.end(), 0);
+			WGT::cmdSnapshot snapshot(moved.data(), size);
+			Assert::IsTrue(snapshot.is_valid());
+			Assert::AreEqual(static_cast<size_t>(4), snapshot.get_param_option_count());
+			Assert::AreEqual(1, snapshot.get_option_id("title"));
+			Assert::IsFalse(snapshot.has_param_option("missing"));
+			Assert::AreEqual(23, snapshot.try_get<int>("buffersize").value());
+			Assert::AreEqual(std::string("Hello"), std::string(snapshot.get_value_short("t")));
+			Assert::IsTrue(snapshot.get_value_short("T").empty());
+			Assert::AreEqual(std::string("fast"), std::string(snapshot.get_value("Mode")));
+			Assert::AreEqual(1, snapshot.get_occurrence_count("verbose"));
+			Assert::AreEqual(0, snapshot.get_occurrence_count("Mode"));
+			Assert::IsTrue(snapshot.try_get<int>("missing").error() == WGT::convError::unknownOption);
+			Assert::AreEqual(static_cast<size_t>(2), snapshot.get_positional_count());
+			Assert::AreEqual(std::string("out.txt"), std::string(snapshot.get_positional(1)));
+
+			// damaged or truncated blobs are not used
+			Assert::IsFalse(WGT::cmdSnapshot(moved.data(), size - 1).is_valid());
+			moved[0] ^= 1;
+			Assert::IsFalse(WGT::cmdSnapshot(moved.data(), size).is_valid());
+		}
+
+		TEST_METHOD(GivenSharedSnapshot_ExpectWorkersSeeEachGeneration)
+		{
+			const std::string name = "/cmdParseTest" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count());
+			auto parent = WGT::sharedSnapshot::create(name, 4096);
+			Assert::IsTrue(parent.is_open());
+
+			// nothing published yet
+			auto worker = WGT::sharedSnapshot::open(name);
+			Assert::IsTrue(worker.is_open());
+			Assert::AreEqual(static_cast<uint64_t>(0), worker.get_generation());
+			Assert::IsFalse(worker.has_param_option("BufferSize"));
+
+			const char* argv[] = { "Sample.exe", "--BufferSize=23" };
+			WGT::cmdParse cmd;
+			cmd.emplace_option("BufferSize", "1000", "b");
+			cmd.emplace_option("Title", "Untitled", "t");
+			Assert::IsTrue(cmd.init(2, argv));
+			Assert::IsTrue(parent.publish(cmd));
+			Assert::AreEqual(static_cast<uint64_t>(1), worker.get_generation());
+			Assert::AreEqual(23, worker.try_get<int>("BufferSize").value());
+			Assert::AreEqual(std::string("Untitled"), worker.get_value("title"));
+			auto option = worker.get_param_option("bufferSize");
+			Assert::AreEqual(std::string("BufferSize"), option.longName);
+			Assert::AreEqual(std::string("b"), option.shortName);
+			Assert::AreEqual(std::string("1000"), option.defaultValue);
+			Assert::AreEqual(std::string("23"), option.paramValue);
+			Assert::IsTrue(worker.get_param_option("missing").longName.empty());
+
+			// a reload replaces the values, whichever slot they are in
+			for (int n = 0; n < 3; n++) {
+				const std::string value = "--BufferSize=" + std::to_string(100 + n);
+				const char* reload[] = { "Sample.exe", value.c_str() };
+				cmd.reset();
+				Assert::IsTrue(cmd.init(2, reload));
+				Assert::IsTrue(parent.publish(cmd));
+				Assert::AreEqual(100 + n, worker.try_get<int>("BufferSize").value());
+			}
+			Assert::AreEqual(static_cast<uint64_t>(4), worker.get_generation());
+
+			// too large for the segment, the current generation stays
+			for (int n = 0; n < 100; n++) {
+				cmd.emplace_option("Option" + std::to_string(n), "default value", "");
+			}
+			Assert::IsFalse(parent.publish(cmd));
+			Assert::AreEqual(102, worker.try_get<int>("BufferSize").value());
+
+			parent.close();
+			Assert::IsFalse(WGT::sharedSnapshot::open(name).is_open());
+			Assert::AreEqual(102, worker.try_get<int>("BufferSize").value());
+
+#ifndef _WIN32
+			// a segment that was left behind, e.g. by a creator that crashed, is made again
+			const int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+			Assert::IsTrue(fd >= 0);
+			::close(fd);
+			auto again = WGT::sharedSnapshot::create(name, 64 * 1024);
+			Assert::IsTrue(again.publish(cmd));
+			Assert::AreEqual(102, WGT::sharedSnapshot::open(name).try_get<int>("BufferSize").value());
+#endif
+		}
+
+		TEST_METHOD(GivenCommandLineString_ExpectWindowsAndPosixQuoting)
+		{
+			WGT::cmdParse cmd;
+			cmd.emplace_option("BufferSize", "1000", "b");
+			cmd.emplace_option("Title", "", "t");
+			Assert::IsTrue(cmd.init_from_string(R"("C:\Program Files\Sample.exe" --BufferSize=23 "--Title=Hello World" C:\in.txt "a \"b\" \\" "")"));
+			std::vector<char> buffer(cmd.write_argv(nullptr, 0).size);
+			Assert::AreEqual(std::string("C:\\Program Files\\Sample.exe"), std::string(cmd.write_argv(buffer.data(), buffer.size()).argv[0]));
+			Assert::AreEqual(23, cmd.try_get<int>("BufferSize").value());
+			Assert::AreEqual(std::string("Hello World"), cmd.get_param_option("Title").paramValue);
+			auto positionals = cmd.get_positionals();
+			Assert::AreEqual(static_cast<size_t>(3), positionals.size());
+			Assert::AreEqual(std::string("C:\\in.txt"), std::string(positionals[0]));
+			Assert::AreEqual(std::string("a \"b\" \\"), std::string(positionals[1]));
+			Assert::IsTrue(positionals[2].empty());
+
+			WGT::cmdParse posix;
+			posix.emplace_option("Title", "", "t");
+			Assert::IsTrue(posix.init_from_string("./sample -t='it is'\\ \"\\$HOME\" 'a\\b' c\\\nd", WGT::quoteRules::posix));
+			Assert::AreEqual(std::string("it is $HOME"), posix.get_param_option("Title").paramValue);
+			Assert::AreEqual(std::string("a\\b"), std::string(posix.get_positionals()[0]));
+			Assert::AreEqual(std::string("cd"), std::string(posix.get_positionals()[1]));
+
+			Assert::IsFalse(posix.init_from_string("   "));
+		}
+
+		TEST_METHOD(GivenRepeatedCommandLines_ExpectCachedSharedResults)
+		{
+			WGT::cmdParse schema;
+			schema.emplace_option("BufferSize", "1000", "b");
+			WGT::parseCache<> cache(schema, 2);
+
+			std::string first = "--BufferSize=1";
+			const char* argv1[] = { "Sample.exe", first.c_str(), "in.txt" };
+			auto a = cache.get(3, argv1);
+			Assert::AreEqual(1, a->try_get<int>("BufferSize").value());
+
+			// equal arguments at other addresses are the same command-line
+			const std::string copy = first;
+			const char* argv1Copy[] = { "Sample.exe", copy.c_str(), "in.txt" };
+			Assert::IsTrue(cache.get(3, argv1Copy) == a);
+			Assert::AreEqual(static_cast<size_t>(1), cache.get_hit_count());
+
+			// the result keeps its own copy of the arguments
+			first = "--BufferSize=9";
+			Assert::AreEqual(std::string("in.txt"), std::string(a->get_positionals()[0]));
+
+			const char* argv2[] = { "Sample.exe", "--BufferSize=2" };
+			const char* argv3[] = { "Sample.exe", "--BufferSize=3" };
+			auto b = cache.get(2, argv2);
+			Assert::IsTrue(cache.get(3, argv1Copy) == a);
+			cache.get(2, argv3);
+			Assert::AreEqual(static_cast<size_t>(2), cache.size());
+			Assert::IsTrue(cache.get(3, argv1Copy) == a);
+			Assert::IsFalse(cache.get(2, argv2) == b);		// least recently used, so evicted
+			Assert::AreEqual(2, b->try_get<int>("BufferSize").value());
+
+			// many threads on a few command-lines
+			const char* const* lines[] = { argv1Copy, argv2, argv3 };
+			const int counts[] = { 3, 2, 2 };
+			std::atomic<int> wrong{ 0 };
+			std::vector<std::thread> threads;
+			for (int t = 0; t < 4; t++) {
+				threads.emplace_back([&, t]() {
+					for (int n = 0; n < 1000; n++) {
+						const int line = (n + t) % 3;
+						auto result = cache.get(counts[line], lines[line]);
+						if (result->try_get<int>("BufferSize").value_or(0) != line + 1) {
+							wrong++;
+						}
+					}
+				});
+			}
+			for (auto& thread : threads) {
+				thread.join();
+			}
+			Assert::AreEqual(0, wrong.load());
+			Assert::AreEqual(static_cast<size_t>(2), cache.size());
+		}
+
+		TEST_METHOD(GivenOverrides_ExpectOnlyDeltaAppliedAndChangesReported)
+		{
+			const char* argv[] = { "Sample.exe", "--BufferSize=23", "--include=a", "--include=b", "-DNAME=1", "--sizes=3,4", "in.txt" };
+			WGT::cmdParse cmd;
+			cmd.emplace_option("BufferSize", "1000", "b");
+			cmd.emplace_option("Title", "Untitled", "t");
+			cmd.emplace_option("include", "", "I");
+			cmd.set_repeat_policy("include", WGT::repeatPolicy::accumulate);
+			cmd.emplace_option("library", "", "l");
+			cmd.set_repeat_policy("library", WGT::repeatPolicy::accumulate);
+			cmd.add_map_option("define", "D");
+			cmd.add_flag_option("verbose", "v");
+			cmd.add_flag_option("quiet", "q");
+			cmd.add_list_option<int>("sizes", "1,2", "s");
+			Assert::IsTrue(cmd.init(7, argv));
+
+			std::vector<int> changed;
+			Assert::IsTrue(cmd.override_options("--BufferSize=64 -vq", changed));
+			Assert::AreEqual(64, cmd.try_get<int>("BufferSize").value());
+			Assert::IsTrue(cmd.is_flag_set("verbose") && cmd.is_flag_set("quiet"));
+			Assert::IsTrue(changed == std::vector<int>{ cmd.get_option_id("BufferSize"), cmd.get_option_id("verbose"), cmd.get_option_id("quiet") });
+
+			// the rest is as it was
+			Assert::AreEqual(0, cmd.get_occurrence_count("Title"));
+			Assert::AreEqual(static_cast<size_t>(2), cmd.get_values("include").size());
+			Assert::AreEqual(std::string("in.txt"), std::string(cmd.get_positionals()[0]));
+
+			// the same value again changes nothing
+			Assert::IsTrue(cmd.override_options("--BufferSize=64 --quiet=no", changed));
+			Assert::IsTrue(changed == std::vector<int>{ cmd.get_option_id("quiet") });
+			Assert::IsFalse(cmd.is_flag_set("quiet"));
+
+			// accumulated values are replaced, map keys are merged
+			Assert::IsTrue(cmd.override_options("--include=c -D:OTHER=2 -DNAME=3", changed));
+			Assert::AreEqual(static_cast<size_t>(1), cmd.get_values("include").size());
+			Assert::IsTrue(cmd.get_map_value("define", "NAME").value() == "3");
+			Assert::IsTrue(cmd.get_map_value("define", "OTHER").value() == "2");
+			Assert::AreEqual(static_cast<size_t>(2), changed.size());
+
+			// options before an error are still applied
+			Assert::IsFalse(cmd.override_options("--Title=\"New Title\" out.txt", changed));
+			Assert::AreEqual(std::string("New Title"), cmd.get_param_option("Title").paramValue);
+			Assert::IsTrue(cmd.get_error_records().back().code == WGT::errorCode::unexpectedArgument);
+			Assert::IsFalse(cmd.override_options("--missing=1", changed));
+			Assert::IsTrue(changed.empty());
+
+			// an option whose value is in error is left as it was
+			Assert::IsFalse(cmd.override_options("--quiet=maybe", changed));
+			Assert::IsFalse(cmd.is_flag_set("quiet"));
+			Assert::IsTrue(changed.empty());
+			Assert::IsFalse(cmd.override_options("--define=", changed));
+			Assert::IsTrue(cmd.get_map_value("define", "NAME").value() == "3");
+			Assert::IsTrue(changed.empty());
+			Assert::IsFalse(cmd.override_options("--sizes=1,x", changed));
+			Assert::AreEqual(static_cast<size_t>(2), cmd.get_list<int>("sizes").size);
+			Assert::AreEqual(1, cmd.get_occurrence_count("sizes"));
+
+			// a long run of overrides keeps the right values as their old text is reclaimed,
+			// and leaves the values of the other options alone
+			Assert::IsTrue(cmd.override_options("--library=m --library=z", changed));
+			for (int n = 0; n < 5000; n++) {
+				const auto value = std::to_string(n) + std::string(40, 'x');
+				Assert::IsTrue(cmd.override_options("--include=" + value + " -DNAME=" + value + " --include=b", changed));
+			}
+			auto values = cmd.get_values("include");
+			Assert::AreEqual(static_cast<size_t>(2), values.size());
+			Assert::IsTrue((values[0] == "4999" + std::string(40, 'x')) && (values[1] == "b"));
+			Assert::IsTrue(cmd.get_map_value("define", "NAME").value() == "4999" + std::string(40, 'x'));
+			Assert::IsTrue(cmd.get_map_value("define", "OTHER").value() == "2");
+			auto libraries = cmd.get_values("library");
+			Assert::IsTrue((libraries.size() == 2) && (libraries[0] == "m") && (libraries[1] == "z"));
+		}
+
+		TEST_METHOD(GivenOverlays_ExpectOverridesOverSharedBase)
+		{
+			const char* argv[] = { "Sample.exe", "--BufferSize=23", "-v" };
+			WGT::cmdParse cmd;
+			cmd.emplace_option("BufferSize", "1000", "b");
+			cmd.emplace_option("Title", "Untitled", "t");
+			cmd.add_flag_option("verbose", "v");
+			cmd.add_flag_option("quiet", "q");
+			cmd.add_list_option<int>("sizes", "1,2", "s");
+			cmd.add_map_option("define", "D");
+			cmd.emplace_option("include", "", "I");
+			cmd.set_repeat_policy("include", WGT::repeatPolicy::accumulate);
+			for (int n = 0; n < 10; n++) {
+				cmd.emplace_option("Option" + std::to_string(n), "0", "");
+			}
+			Assert::IsTrue(cmd.init(3, argv));
+
+			WGT::cmdOverlay<> request(cmd);
+			Assert::AreEqual(23, request.try_get<int>("BufferSize").value());
+			Assert::AreEqual(std::string("Untitled"), std::string(request.get_value("title")));
+			Assert::IsTrue(request.is_flag_set("verbose"));
+
+			Assert::IsTrue(request.set_value("BufferSize", "64"));
+			Assert::IsTrue(request.set_value("verbose", "no"));
+			Assert::IsFalse(request.set_value("missing", "1"));
+			Assert::AreEqual(64, request.try_get<int>("BufferSize").value());
+			Assert::IsFalse(request.is_flag_set("verbose"));
+			Assert::IsTrue(request.try_get<int>("missing").error() == WGT::convError::unknownOption);
+
+			// only single values can be overridden; an empty flag value sets the flag
+			Assert::IsFalse(request.set_value("sizes", "3,4"));
+			Assert::IsFalse(request.set_value("define", "NAME=1"));
+			Assert::IsFalse(request.set_value("include", "a"));
+			Assert::IsFalse(request.set_value("quiet", "maybe"));
+			Assert::IsTrue(request.set_value("quiet", ""));
+			Assert::IsTrue(request.is_flag_set("quiet"));
+			request.clear_value("quiet");
+			Assert::IsFalse(request.is_flag_set("quiet"));
+
+			// the base is not changed
+			Assert::AreEqual(23, cmd.try_get<int>("BufferSize").value());
+			Assert::IsTrue(cmd.is_flag_set("verbose"));
+
+			// more overrides than fit inline
+			for (int n = 0; n < 10; n++) {
+				Assert::IsTrue(request.set_value("Option" + std::to_string(n), std::to_string(n + 100)));
+			}
+			Assert::AreEqual(static_cast<size_t>(12), request.get_override_count());
+			Assert::AreEqual(109, request.try_get<int>("Option9").value());
+			Assert::IsTrue(request.set_value("BufferSize", "65"));
+			Assert::AreEqual(65, request.try_get<int>("BufferSize").value());
+
+			request.clear_value("BufferSize");
+			Assert::IsFalse(request.is_overridden("BufferSize"));
+			Assert::AreEqual(23, request.try_get<int>("BufferSize").value());
+			Assert::AreEqual(static_cast<size_t>(11), request.get_override_count());
+			for (int n = 0; n < 10; n++) {
+				Assert::AreEqual(n + 100, request.try_get<int>("Option" + std::to_string(n)).value());
+			}
+		}
+
+		TEST_METHOD(GivenSecondInit_ExpectOnlyNewArgumentsParsed)
+		{
+			WGT::cmdParse cmd;
+			cmd.emplace_option("BufferSize", "1000", "b");
+			cmd.emplace_option("Title", "", "t");
+
+			const char* argv1[] = { "Sample.exe", "--BufferSize=23", "--Title=x", "in.txt", "out.txt" };
+			Assert::IsTrue(cmd.init(5, argv1));
+
+			// the indices into argv are of the second command-line, not of both
+			const char* argv2[] = { "Sample.exe", "next.txt", "--", "rest" };
+			Assert::IsTrue(cmd.init(4, argv2));
+			Assert::AreEqual(1000, cmd.try_get<int>("BufferSize").value());
+			Assert::IsTrue(cmd.get_param_option("Title").paramValue.empty());
+			Assert::AreEqual(static_cast<size_t>(1), cmd.get_positionals().size());
+			Assert::AreEqual(std::string("next.txt"), std::string(cmd.get_positionals()[0]));
+			Assert::AreEqual(static_cast<size_t>(1), cmd.get_passthrough().size);
+			Assert::AreEqual(std::string("rest"), std::string(cmd.get_passthrough()[0]));
+			Assert::AreEqual(static_cast<size_t>(3), cmd.get_arguments().size());
+		}
+
+		TEST_METHOD(GivenSubcommand_ExpectWrittenWithItsArguments)
+		{
+			auto setup = [](WGT::cmdParse& cmd) {
+				cmd.emplace_option("verbose", "", "v");
+				cmd.add_subcommand("clone", [](WGT::cmdParse& sub) {
+					sub.emplace_option("depth", "0", "d");
+				});
+			};
+			WGT::cmdParse cmd;
+			setup(cmd);
+
+			// a second init() gives the subcommand the second argv
+			const char* argv1[] = { "Sample.exe", "--verbose=1", "--verbose=2", "clone", "--depth=3", "a.git" };
+			Assert::IsTrue(cmd.init(6, argv1));
+			const char* argv2[] = { "Sample.exe", "clone", "--depth=5", "b.git" };
+			Assert::IsTrue(cmd.init(4, argv2));
+			Assert::AreEqual(5, cmd.get_subcommand()->try_get<int>("depth").value());
+			Assert::AreEqual(std::string("b.git"), std::string(cmd.get_subcommand()->get_positionals()[0]));
+
+			const char* argv3[] = { "Sample.exe", "--verbose=1", "clone", "--depth=3", "a.git" };
+			Assert::IsTrue(cmd.init(5, argv3));
+			std::vector<char> buffer(cmd.write_argv(nullptr, 0).size);
+			auto args = cmd.write_argv(buffer.data(), buffer.size());
+			Assert::AreEqual(5, args.argc);
+			for (int n = 0; n < args.argc; n++) {
+				Assert::AreEqual(std::string(argv3[n]), std::string(args.argv[n]));
+			}
+
+			// the subcommand's parse is nested in the snapshot
+			std::vector<uint32_t> blob(cmd.write_snapshot(nullptr, 0) / sizeof(uint32_t) + 1);
+			cmd.write_snapshot(blob.data(), blob.size() * sizeof(uint32_t));
+			WGT::cmdSnapshot snapshot(blob.data(), blob.size() * sizeof(uint32_t));
+			Assert::IsTrue(snapshot.get_subcommand_name() == "clone");
+			auto sub = snapshot.get_subcommand();
+			Assert::IsTrue(sub.is_valid());
+			Assert::AreEqual(3, sub.try_get<int>("depth").value());
+			Assert::IsTrue(sub.get_positional(0) == "a.git");
+			Assert::IsFalse(sub.has_param_option("verbose"));
+		}
+
+		TEST_METHOD(GivenUtf8Text_ExpectWideRoundTrip)
+		{
+			std::string text = "caf\xC3\xA9 \xE2\x82\xAC \xF0\x9F\x98\x80";
+			auto wide = WGT::string_utils::ascii2wide_convert(text);
+			Assert::AreEqual(text, WGT::string_utils::wide2ascii_convert(wide));
+			Assert::IsTrue(wide.substr(0, 6) == L"caf\u00E9 \u20AC");
+
+			// an invalid byte is replaced
+			std::string invalid = "a\xFF" "b";
+			Assert::IsTrue(WGT::string_utils::ascii2wide_convert(invalid) == L"a\uFFFDb");
+		}
 	};
 }
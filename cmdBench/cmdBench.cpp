@@ -0,0 +1,423 @@
+/*
+*	Benchmarks of the command-line parser. Each case repeats its work and
+*	reports the best of five runs.
+*
+*	Usage:
+*		cmdBench [case ...]		(all cases if none are named)
+*
+*	Build the Release configuration of cmdBench.vcxproj, or elsewhere:
+*		g++ -std=c++17 -O2 -I.. cmdBench.cpp -o cmdBench -pthread
+*
+*	The header is found through the include path, so the same source can be
+*	built against an older tree to compare with it. Define CMDPARSE_BENCH_BASIC
+*	to build only the cases that use nothing newer than the original cmdParse
+*	(see README.md, "Benchmarks").
+*/
+
+#include "cmdparse.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+// count the allocations, for the cases that report them
+static size_t allocations = 0;
+
+// delete is kept out of line: inlined, GCC sees free() of memory from operator new (-Wmismatched-new-delete)
+#if defined(__GNUC__)
+#define BENCH_NOINLINE __attribute__((noinline))
+#else
+#define BENCH_NOINLINE
+#endif
+
+void* operator new(std::size_t size) {
+	allocations++;
+	if (void* p = std::malloc(size ? size : 1)) {
+		return p;
+	}
+	throw std::bad_alloc();
+}
+
+BENCH_NOINLINE void operator delete(void* p) noexcept {
+	std::free(p);
+}
+
+BENCH_NOINLINE void operator delete(void* p, std::size_t) noexcept {
+	std::free(p);
+}
+
+namespace
+{
+	using clock = std::chrono::steady_clock;
+
+	// a value the optimiser cannot drop
+	volatile size_t sink = 0;
+
+	/*!	@brief Time @c fn, best of five runs, in nanoseconds per repeat
+	*/
+	template <typename Fn>
+	double bestOf(size_t repeats, Fn&& fn) {
+		double best = 0;
+		for (int run = 0; run < 5; run++) {
+			const auto start = clock::now();
+			for (size_t n = 0; n < repeats; n++) {
+				fn();
+			}
+			const double ns = std::chrono::duration<double, std::nano>(clock::now() - start).count() / static_cast<double>(repeats);
+			best = (run == 0) ? ns : (std::min)(best, ns);
+		}
+		return best;
+	}
+
+	std::string optionName(size_t n) {
+		return "option" + std::to_string(n);
+	}
+
+	/*!	@brief Construction from N options (2% duplicate names, shuffled), then has_param_option() over every name
+	*/
+	void registration() {
+		std::printf("registration: construct from N options, then has_param_option() per name\n");
+		for (size_t count : { 1000, 10000, 100000 }) {
+			std::vector<WGT::cmdOption> options;
+			std::vector<std::string> names;
+			for (size_t n = 0; n < count; n++) {
+				// every 50th option repeats the name of the one before it
+				names.push_back(optionName(((n % 50) == 49) ? n - 1 : n));
+				options.emplace_back(names.back(), "0", "");
+			}
+			std::mt19937 random(42);
+			std::shuffle(options.begin(), options.end(), random);
+
+			const double build = bestOf(1, [&]() {
+				WGT::cmdParse cmd(options);
+				sink += cmd.get_param_option_count();
+			});
+
+			WGT::cmdParse cmd(options);
+			const double lookup = bestOf(1, [&]() {
+				for (auto& name : names) {
+					sink += cmd.has_param_option(name);
+				}
+			}) / static_cast<double>(count);
+
+			std::printf("  %6zu options: %9.2f ms, %6.0f ns per lookup\n", count, build / 1e6, lookup);
+		}
+	}
+
+	/*!	@brief get_helpstring() for 10k options without descriptions, as the original cmdParse could
+	*/
+	void helpNames() {
+		std::printf("help-names: get_helpstring() for 10k options, no descriptions\n");
+		std::vector<WGT::cmdOption> options;
+		for (size_t n = 0; n < 10000; n++) {
+			options.emplace_back(optionName(n), std::to_string(n), "o" + std::to_string(n));
+		}
+		WGT::cmdParse cmd(options);
+		const char* argv[] = { "app.exe" };
+		cmd.init(1, argv);
+
+		sink += cmd.get_helpstring().size();
+		const auto before = allocations;
+		const double ns = bestOf(20, [&]() { sink += cmd.get_helpstring().size(); });
+		std::printf("  %8.1f us, %7.1f allocations\n", ns / 1e3, static_cast<double>(allocations - before) / 100.0);
+	}
+
+#ifndef CMDPARSE_BENCH_BASIC
+	/*!	@brief has_param_option() per name before and after freeze(), and the time freeze() takes
+	*/
+	void freezing() {
+		std::printf("freeze: has_param_option() per name, sorted index then perfect hash\n");
+		for (size_t count : { 20000, 100000 }) {
+			std::vector<WGT::cmdOption> options;
+			std::vector<std::string> names;
+			for (size_t n = 0; n < count; n++) {
+				names.push_back(optionName(n));
+				options.emplace_back(names.back(), "0", "o" + std::to_string(n));
+			}
+			std::mt19937 random(42);
+			std::shuffle(names.begin(), names.end(), random);
+
+			WGT::cmdParse cmd(options);
+			auto lookup = [&]() {
+				return bestOf(1, [&]() {
+					for (auto& name : names) {
+						sink += cmd.has_param_option(name);
+					}
+				}) / static_cast<double>(count);
+			};
+
+			const double sorted = lookup();
+
+			// freeze() needs an unfrozen parser each time, so time the copy on its own too
+			const double copy = bestOf(1, [&]() {
+				WGT::cmdParse unfrozen(cmd);
+				sink += unfrozen.get_param_option_count();
+			});
+			const double freeze = bestOf(1, [&]() {
+				WGT::cmdParse unfrozen(cmd);
+				sink += unfrozen.freeze();
+			}) - copy;
+			cmd.freeze();
+			const double hashed = lookup();
+
+			std::printf("  %6zu options: %6.0f ns sorted, %6.0f ns frozen, freeze() %6.2f ms\n", count, sorted, hashed, freeze / 1e6);
+		}
+	}
+
+	/*!	@brief Help for 10k options with descriptions: built for a new width, kept, and written to a file descriptor
+	*/
+	void help() {
+		std::printf("help: 10k options with descriptions\n");
+		WGT::cmdParse cmd;
+		for (size_t n = 0; n < 10000; n++) {
+			const auto name = optionName(n);
+			cmd.emplace_option(name, std::to_string(n), "o" + std::to_string(n));
+			cmd.set_description(name, "Sets the value of " + name + ", which is read once the file has been opened and is then kept for the whole run.");
+		}
+
+		const char* argv[] = { "app.exe" };
+		cmd.init(1, argv);
+
+#ifdef _WIN32
+		FILE* null = std::fopen("NUL", "w");
+		const int fd = (null != nullptr) ? _fileno(null) : -1;
+#else
+		FILE* null = std::fopen("/dev/null", "w");
+		const int fd = (null != nullptr) ? fileno(null) : -1;
+#endif
+
+		size_t width = 100;
+		auto perCall = [&](const char* what, auto&& fn) {
+			fn();
+			const auto before = allocations;
+			const double ns = bestOf(20, fn);
+			std::printf("  %-32s %8.1f us, %5.1f allocations\n", what, ns / 1e3, static_cast<double>(allocations - before) / 100.0);
+		};
+
+		perCall("get_helpstring(), new width", [&]() { sink += cmd.get_helpstring(width = (width == 100) ? 101 : 100).size(); });
+		perCall("get_helpstring(), kept", [&]() { sink += cmd.get_helpstring(100).size(); });
+		if (fd >= 0) {
+			perCall("write_help(fd), kept", [&]() { sink += cmd.write_help(fd, 100); });
+			std::fclose(null);
+		}
+	}
+
+	/*!	@brief find_options() over 10k options with descriptions, and the same search as a scan of the text
+	*/
+	void search() {
+		std::printf("search: find_options() over 10k options with descriptions\n");
+		WGT::cmdParse cmd;
+		std::vector<std::string> texts;
+		for (size_t n = 0; n < 10000; n++) {
+			const auto name = optionName(n);
+			const auto description = "Sets the value of " + name + ", which is read once the file has been opened and is then kept for the whole run.";
+			cmd.emplace_option(name, std::to_string(n), "o" + std::to_string(n));
+			cmd.set_description(name, description);
+
+			// the text find_options() compares, lowercased
+			std::string text = name + "\no" + std::to_string(n) + "\n" + description;
+			for (auto& c : text) {
+				c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+			}
+			texts.push_back(text);
+		}
+
+		// adding a description drops the index, so each run builds it again
+		const double build = bestOf(1, [&]() {
+			cmd.set_description("option0", "Sets the value of option0.");
+			sink += cmd.find_options("option4711").size();
+		});
+		std::printf("  %-32s %8.2f ms\n", "first search, builds the index", build / 1e6);
+
+		for (const char* term : { "option4711", "option", "47" }) {
+			const double ns = bestOf(100, [&]() { sink += cmd.find_options(term).size(); });
+			const auto found = cmd.find_options(term).size();
+			const double scan = bestOf(10, [&]() {
+				size_t count = 0;
+				for (auto& text : texts) {
+					count += (text.find(term) != std::string::npos);
+				}
+				sink += count;
+			});
+			const auto what = "\"" + std::string(term) + "\", " + std::to_string(found) + " found";
+			std::printf("  %-32s %8.1f us, %8.1f us scanning\n", what.c_str(), ns / 1e3, scan / 1e3);
+		}
+	}
+
+	/*!	@brief 60 commands of 200 options each: one flat parser against subcommands, constructed and parsing one command-line
+	*/
+	void subcommands() {
+		std::printf("subcommands: 60 commands of 200 options, construct and init()\n");
+		std::vector<WGT::cmdOption> flatOptions;
+		for (size_t command = 0; command < 60; command++) {
+			for (size_t n = 0; n < 200; n++) {
+				flatOptions.emplace_back("command" + std::to_string(command) + "-" + optionName(n), "0", "");
+			}
+		}
+
+		const char* flatArgv[] = { "app.exe", "--command7-option5=1", "--command7-option150=2" };
+		const double flat = bestOf(5, [&]() {
+			WGT::cmdParse cmd(flatOptions);
+			cmd.init(3, flatArgv);
+			sink += cmd.get_param_option_count();
+		});
+
+		const char* argv[] = { "app.exe", "command7", "--option5=1", "--option150=2" };
+		const double sub = bestOf(50, [&]() {
+			WGT::cmdParse cmd;
+			for (size_t command = 0; command < 60; command++) {
+				cmd.add_subcommand("command" + std::to_string(command), [](WGT::cmdParse& parser) {
+					for (size_t n = 0; n < 200; n++) {
+						parser.emplace_option(optionName(n), "0", "");
+					}
+				});
+			}
+			cmd.init(4, argv);
+			sink += cmd.get_subcommand()->get_param_option_count();
+		});
+
+		std::printf("  %-32s %8.2f ms\n  %-32s %8.2f ms\n", "12000 options, flat", flat / 1e6, "60 subcommands, one used", sub / 1e6);
+	}
+
+	/*!	@brief parseCache::get() hits against parsing with a copy of a 30-option schema
+	*/
+	void cache() {
+		std::printf("cache: 30-option schema, 6 arguments\n");
+		WGT::cmdParse schema;
+		for (size_t n = 0; n < 30; n++) {
+			schema.emplace_option(optionName(n), "0", "o" + std::to_string(n));
+		}
+		schema.freeze();
+
+		const char* argv[] = { "app.exe", "--option1=10", "--option7=20", "-o12:30", "--option20=40", "-o29:50", "--option3=60" };
+		const double parse = bestOf(10000, [&]() {
+			WGT::cmdParse cmd(schema);
+			cmd.init(7, argv);
+			sink += cmd.get_value("option7").size();
+		});
+
+		WGT::parseCache<> results(schema);
+		sink += results.get(7, argv)->get_param_option_count();
+		const double hit = bestOf(10000, [&]() {
+			sink += results.get(7, argv)->get_value("option7").size();
+		});
+
+		std::printf("  %-32s %8.2f us\n  %-32s %8.2f us\n", "copy of the schema and init()", parse / 1e3, "cache hit", hit / 1e3);
+	}
+
+	/*!	@brief override_options() of one option against reset() and init() of the whole command-line, 200 options with 50 given
+	*/
+	void overriding() {
+		std::printf("override: 200 options, 50 given\n");
+		WGT::cmdParse cmd;
+		for (size_t n = 0; n < 200; n++) {
+			cmd.emplace_option(optionName(n), "0", "o" + std::to_string(n));
+		}
+
+		std::vector<std::string> args;
+		for (size_t n = 0; n < 200; n += 4) {
+			args.push_back("--" + optionName(n) + "=" + std::to_string(n));
+		}
+		std::vector<const char*> argv{ "app.exe" };
+		for (auto& arg : args) {
+			argv.push_back(arg.c_str());
+		}
+		const int argc = static_cast<int>(argv.size());
+
+		const double reparse = bestOf(1000, [&]() {
+			cmd.reset();
+			cmd.init(argc, argv.data());
+			sink += cmd.get_value("option8").size();
+		});
+
+		std::vector<int> changed;
+		bool odd = false;
+		const double override = bestOf(10000, [&]() {
+			cmd.override_options((odd = !odd) ? "--option8=1" : "--option8=2", changed);
+			sink += changed.size();
+		});
+
+		std::printf("  %-32s %8.2f us\n  %-32s %8.2f us\n", "reset() and init()", reparse / 1e3, "override_options() of one", override / 1e3);
+	}
+
+	/*!	@brief An overlay that sets and reads two values, against a copy of the parser with one override
+	*/
+	void overlay() {
+		std::printf("overlay: frozen base of 200 options\n");
+		WGT::cmdParse base;
+		for (size_t n = 0; n < 200; n++) {
+			base.emplace_option(optionName(n), "0", "o" + std::to_string(n));
+		}
+		base.freeze();
+		const char* argv[] = { "app.exe", "--option10=5", "--option20=6" };
+		base.init(3, argv);
+
+		const double overlaid = bestOf(10000, [&]() {
+			WGT::cmdOverlay<> request(base);
+			request.set_value("option10", "64");
+			request.set_value("option30", "128");
+			sink += request.get_value("option10").size() + request.get_value("option20").size();
+		});
+
+		std::vector<int> changed;
+		const double copied = bestOf(10000, [&]() {
+			WGT::cmdParse request(base);
+			request.override_options("--option10=64 --option30=128", changed);
+			sink += request.get_value("option10").size() + request.get_value("option20").size();
+		});
+
+		std::printf("  %-32s %8.2f us\n  %-32s %8.2f us\n", "overlay, two set and two read", overlaid / 1e3, "copy and override_options()", copied / 1e3);
+	}
+#endif
+
+	struct benchCase
+	{
+		const char* name;
+		void (*run)();
+	};
+
+	const benchCase cases[] = {
+		{ "registration", registration },
+		{ "help-names", helpNames },
+#ifndef CMDPARSE_BENCH_BASIC
+		{ "freeze", freezing },
+		{ "help", help },
+		{ "search", search },
+		{ "subcommands", subcommands },
+		{ "cache", cache },
+		{ "override", overriding },
+		{ "overlay", overlay },
+#endif
+	};
+}
+
+int main(int argc, const char* argv[])
+{
+	bool ran = false;
+	for (auto& c : cases) {
+		bool wanted = (argc < 2);
+		for (int n = 1; n < argc; n++) {
+			wanted = wanted || (std::strcmp(argv[n], c.name) == 0);
+		}
+		if (wanted) {
+			c.run();
+			ran = true;
+		}
+	}
+
+	if (!ran) {
+		std::fprintf(stderr, "cases:");
+		for (auto& c : cases) {
+			std::fprintf(stderr, " %s", c.name);
+		}
+		std::fprintf(stderr, "\n");
+		return 2;
+	}
+	return 0;
+}
@@ -0,0 +1,226 @@
+/*
+*	Batch validator: checks a file of command-lines against a set of options,
+*	using every core on the machine.
+*
+*	Usage:
+*		cmdValidate --schema=options.txt --input=commands.txt [--threads=8]
+*		cmdValidate --help[=text]
+*
+*	The schema file has one option per line, in the form
+*		longName[,defaultValue[,shortName]]
+*	Blank lines and lines that begin with '#' are ignored.
+*
+*	The input file has one command-line per line, split as the C runtime
+*	splits a Windows command-line. The first token of each line is taken as
+*	the executable name, as in argv[0].
+*/
+
+#include "../cmdparse.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+namespace
+{
+	// Number of lines a worker claims at a time
+	constexpr size_t chunkSize = 256;
+
+	bool readFile(const std::string& fileName, std::string& contents) {
+		std::ifstream file(fileName, std::ios::binary);
+		if (!file) {
+			return false;
+		}
+
+		file.seekg(0, std::ios::end);
+		contents.resize(static_cast<size_t>(file.tellg()));
+		file.seekg(0, std::ios::beg);
+		file.read(&contents[0], static_cast<std::streamsize>(contents.size()));
+		return true;
+	}
+
+	// Split the buffer into lines (views into the buffer)
+	std::vector<std::string_view> splitLines(std::string_view buffer) {
+		std::vector<std::string_view> lines;
+		size_t start = 0;
+		while (start < buffer.size()) {
+			auto end = buffer.find('\n', start);
+			if (end == std::string_view::npos) {
+				end = buffer.size();
+			}
+
+			auto line = buffer.substr(start, end - start);
+			if (!line.empty() && (line.back() == '\r')) {
+				line.remove_suffix(1);
+			}
+
+			lines.push_back(line);
+			start = end + 1;
+		}
+
+		return lines;
+	}
+
+	bool loadSchema(const std::string& fileName, WGT::cmdParse& schema) {
+		std::string contents;
+		if (!readFile(fileName, contents)) {
+			return false;
+		}
+
+		std::vector<WGT::cmdOption> options;
+		for (auto line : splitLines(contents)) {
+			std::string entry(line);
+			WGT::string_utils::trim(entry);
+			if (entry.empty() || (entry[0] == '#')) {
+				continue;
+			}
+
+			std::string fields[3];
+			std::istringstream ss(entry);
+			for (auto& field : fields) {
+				std::getline(ss, field, ',');
+				WGT::string_utils::trim(field);
+			}
+
+			options.emplace_back(std::move(fields[0]), std::move(fields[1]), std::move(fields[2]));
+		}
+
+		schema.add_param_options(std::move(options));
+		return true;
+	}
+
+	/*	Validate every line, storing the errors for line n in lineErrors[n]
+	*
+	*	Each thread works on its own copy of the frozen schema, and claims
+	*	chunks of lines from a shared cursor until none are left. Threads that
+	*	finish their chunks early simply claim more, so the load is balanced
+	*	without any locking.
+	*/
+	size_t validate(const WGT::cmdParse& schema, const std::vector<std::string_view>& lines,
+		std::vector<std::string>& lineErrors, unsigned threadCount) {
+
+		std::atomic<size_t> cursor{ 0 };
+		std::atomic<size_t> failures{ 0 };
+
+		auto worker = [&]() {
+			WGT::cmdParse cmd = schema;
+			size_t localFailures = 0;
+
+			for (;;) {
+				const size_t first = cursor.fetch_add(chunkSize);
+				if (first >= lines.size()) {
+					break;
+				}
+
+				const size_t last = (std::min)(first + chunkSize, lines.size());
+				for (size_t n = first; n < last; n++) {
+					if (lines[n].find_first_not_of(" \t") == std::string_view::npos) {
+						continue;
+					}
+
+					cmd.reset();
+					if (!cmd.init_from_string(lines[n]) || cmd.has_errors()) {
+						for (auto& e : cmd.get_errors()) {
+							if (!lineErrors[n].empty()) {
+								lineErrors[n] += "; ";
+							}
+							lineErrors[n] += e;
+						}
+						localFailures++;
+					}
+				}
+			}
+
+			failures += localFailures;
+		};
+
+		std::vector<std::thread> threads;
+		for (unsigned n = 1; n < threadCount; n++) {
+			threads.emplace_back(worker);
+		}
+		worker();
+
+		for (auto& t : threads) {
+			t.join();
+		}
+
+		return failures;
+	}
+}
+
+
+int main(int argc, const char* argv[])
+{
+	WGT::cmdParse cmd;
+	cmd.emplace_option("schema", "", "s");
+	cmd.emplace_option("input", "", "i");
+	cmd.emplace_option("threads", "0", "t");
+	cmd.set_description("schema", "File of options to check against, one per line: longName[,defaultValue[,shortName]]");
+	cmd.set_description("input", "File of command-lines to check, one per line");
+	cmd.emplace_option("help", "", "h");
+	cmd.set_description("threads", "Number of threads to use, or 0 for one per core");
+	cmd.set_description("help", "Show help, or only the options that mention the given text (--help=text)");
+
+	if (cmd.init(argc, argv) && (cmd.get_occurrence_count("help") > 0)) {
+		auto term = cmd.get_param_option("help").paramValue;
+		if (term.empty()) {
+			cmd.write_help(stdout);
+		}
+		else {
+			cmd.write_help(stdout, term);
+		}
+		return 0;
+	}
+
+	if (cmd.has_errors() || cmd.get_param_option("schema").paramValue.empty() || cmd.get_param_option("input").paramValue.empty()) {
+		for (auto& e : cmd.get_errors()) {
+			std::fprintf(stderr, "%s\n", e.c_str());
+		}
+		cmd.write_help(stderr);
+		return 2;
+	}
+
+	WGT::cmdParse schema;
+	if (!loadSchema(cmd.get_param_option("schema").paramValue, schema)) {
+		std::fprintf(stderr, "Unable to read schema file\n");
+		return 2;
+	}
+
+	schema.freeze();
+	for (auto& e : schema.get_errors()) {
+		std::fprintf(stderr, "schema: %s\n", e.c_str());
+	}
+	schema.clear_errors();
+
+	std::string contents;
+	if (!readFile(cmd.get_param_option("input").paramValue, contents)) {
+		std::fprintf(stderr, "Unable to read input file\n");
+		return 2;
+	}
+
+	unsigned threadCount = cmd.try_get<unsigned>("threads").value_or(0);
+	if (threadCount == 0) {
+		threadCount = (std::max)(1u, std::thread::hardware_concurrency());
+	}
+
+	auto start = std::chrono::steady_clock::now();
+
+	auto lines = splitLines(contents);
+	std::vector<std::string> lineErrors(lines.size());
+	auto failures = validate(schema, lines, lineErrors, threadCount);
+
+	auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	for (size_t n = 0; n < lineErrors.size(); n++) {
+		if (!lineErrors[n].empty()) {
+			std::printf("line %zu: %s\n", n + 1, lineErrors[n].c_str());
+		}
+	}
+
+	std::fprintf(stderr, "%zu lines, %zu invalid, %u threads, %.3f s (%.0f lines/sec)\n",
+		lines.size(), failures, threadCount, elapsed, (elapsed > 0) ? lines.size() / elapsed : 0.0);
+
+	return (failures == 0) ? 0 : 1;
+}
@@ -5,23 +5,481 @@
 * 
 *	Basic command-line parser for C++ applications.
 * 
+*	Define CMDPARSE_NO_EXCEPTIONS to build without exceptions (it is defined
+*	automatically when the compiler has exceptions turned off). Conversions
+*	then never throw; use try_get() to find out whether they failed.
+* 
 *	TODO: 
 *		- Make compatible with wchar_t configuration
 */
 
 #pragma once
+
+#if !defined(CMDPARSE_NO_EXCEPTIONS) && !defined(__cpp_exceptions) && !defined(_CPPUNWIND)
+#define CMDPARSE_NO_EXCEPTIONS
+#endif
+
 #include "string_utils.h"
+#include "hash_utils.h"
+#include <array>
+#include <atomic>
 #include <cassert>
+#include <cctype>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
 #include <exception>
+#include <functional>
+#include <initializer_list>
+#include <limits>
+#include <ratio>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <typeindex>
+#include <unordered_map>
+#include <utility>
 #include <vector>
-#include <set>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <optional>
 #include <iostream>
 #include <algorithm>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define CMDPARSE_SSE2
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 namespace WGT
 {
 
+	/*!	@brief Reasons a conversion by @c try_get can fail
+	*/
+	enum class convError : uint8_t
+	{
+		none,
+		empty,			// there is no value to convert
+		invalid,		// the value is not of the requested type
+		outOfRange,		// the value does not fit the requested type
+		unknownOption	// there is no option with the given name
+	};
+
+	/*!	@brief Result of a conversion: either a value, or a @c convError
+	* 
+	*	Equivalent to @c std::expected<T, convError>, for C++17.
+	* 
+	*   Example:
+	*	```cpp
+	*	if (auto size = cmd.try_get<int>("BufferSize")) {
+	*		use(*size);
+	*	}
+	*	```
+	*/
+	template <typename T>
+	class convResult
+	{
+	public:
+		convResult(T value) : m_value{ std::move(value) }, m_error{ convError::none } {}
+		convResult(convError error) : m_error{ error } { assert(error != convError::none); }
+
+		bool has_value() const noexcept { return m_error == convError::none; }
+		explicit operator bool() const noexcept { return has_value(); }
+
+		const T& value() const noexcept { assert(has_value()); return m_value; }
+		const T& operator*() const noexcept { return value(); }
+		const T* operator->() const noexcept { return &value(); }
+		T value_or(T fallback) const { return has_value() ? m_value : fallback; }
+
+		convError error() const noexcept { return m_error; }
+
+	private:
+		T m_value{};
+		convError m_error;
+	};
+
+	/*!	@brief Convert text to a number with @c std::from_chars
+	* 
+	*	Locale independent, and the whole text must be used. A leading '+' is
+	*	allowed, since @c std::from_chars does not accept one.
+	*/
+	template <typename T>
+	convResult<T> parseNumber(std::string_view text)
+	{
+		if (text.empty()) {
+			return convError::empty;
+		}
+
+		if ((text.front() == '+') && (text.size() > 1) && (text[1] != '-')) {
+			text.remove_prefix(1);
+		}
+
+		T value{};
+		auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+		if (result.ec == std::errc::result_out_of_range) {
+			return convError::outOfRange;
+		}
+		if ((result.ec != std::errc()) || (result.ptr != text.data() + text.size())) {
+			return convError::invalid;
+		}
+		return value;
+	}
+
+	/*!	@brief A size in bytes, for options such as "64KiB" or "2G"
+	* 
+	*	Converts to @c uint64_t. See @c option_traits<byteSize> for the suffixes.
+	*/
+	struct byteSize
+	{
+		uint64_t bytes{ 0 };
+
+		constexpr operator uint64_t() const noexcept { return bytes; }
+	};
+
+	/*!	@brief Converts option text to @c T
+	* 
+	*	Provided for strings, @c bool, every integer and floating-point type,
+	*	@c std::chrono::duration and @c byteSize. To convert your own type,
+	*	specialise this template with a static @c parse function that does not
+	*	throw:
+	* 
+	*	```cpp
+	*	namespace WGT {
+	*		template <>
+	*		struct option_traits<point> {
+	*			static convResult<point> parse(std::string_view text);
+	*		};
+	*	}
+	*	...
+	*	auto origin = cmd.try_get<point>("origin");
+	*	```
+	*	The text passed to @c parse has no leading or trailing spaces.
+	*/
+	template <typename T, typename Enable = void>
+	struct option_traits
+	{
+		static_assert(!std::is_same_v<T, T>, "no converter for this type: specialise WGT::option_traits<T>");
+	};
+
+	template <>
+	struct option_traits<std::string>
+	{
+		static convResult<std::string> parse(std::string_view text) {
+			return std::string(text);
+		}
+	};
+
+	template <>
+	struct option_traits<std::string_view>
+	{
+		static convResult<std::string_view> parse(std::string_view text) noexcept {
+			return text;
+		}
+	};
+
+	/*!	@brief Accepts true/false, yes/no and 1/0, in any case
+	*/
+	template <>
+	struct option_traits<bool>
+	{
+		static convResult<bool> parse(std::string_view text) noexcept {
+			if (text.empty()) {
+				return convError::empty;
+			}
+
+			bool value = false;
+			if (!string_utils::is_boolean(text, value)) {
+				return convError::invalid;
+			}
+			return value;
+		}
+	};
+
+	/*!	@brief Integers of every width, signed or unsigned, and floating-point numbers
+	*/
+	template <typename T>
+	struct option_traits<T, std::enable_if_t<std::is_arithmetic_v<T> && !std::is_same_v<T, bool>>>
+	{
+		static convResult<T> parse(std::string_view text) noexcept {
+			return parseNumber<T>(text);
+		}
+	};
+
+	/*!	@brief Durations such as "250ms", "1.5s" or "2h"
+	* 
+	*	The units are ns, us, ms, s, m (or min), h and d. A number without a
+	*	unit is taken in the units of the duration type. Converting to a coarser
+	*	integer duration truncates, e.g. "1500us" is 1 millisecond.
+	*/
+	template <typename Rep, typename Period>
+	struct option_traits<std::chrono::duration<Rep, Period>>
+	{
+		using duration = std::chrono::duration<Rep, Period>;
+
+		static convResult<duration> parse(std::string_view text) noexcept {
+			if (text.empty()) {
+				return convError::empty;
+			}
+
+			auto length = text.find_first_not_of("+-.0123456789");
+			auto number = text.substr(0, length);
+			auto unit = (length == std::string_view::npos) ? std::string_view{} : text.substr(length);
+			while (!unit.empty() && (unit.front() == ' ')) unit.remove_prefix(1);
+
+			if (unit.empty())							return scale<Period>(number);
+			if (unit == "ns")							return scale<std::nano>(number);
+			if (unit == "us")							return scale<std::micro>(number);
+			if (unit == "ms")							return scale<std::milli>(number);
+			if (unit == "s")							return scale<std::ratio<1>>(number);
+			if ((unit == "m") || (unit == "min"))		return scale<std::ratio<60>>(number);
+			if (unit == "h")							return scale<std::ratio<3600>>(number);
+			if (unit == "d")							return scale<std::ratio<86400>>(number);
+			return convError::invalid;
+		}
+
+	private:
+		// convert a count of Unit into a count of Period, checking that it fits Rep
+		template <typename Unit>
+		static convResult<duration> scale(std::string_view number) noexcept {
+			using ratio = std::ratio_divide<Unit, Period>;
+
+			if (std::is_floating_point_v<Rep> || (number.find('.') != std::string_view::npos)) {
+				auto value = parseNumber<double>(number);
+				if (!value) {
+					return value.error();
+				}
+
+				const double count = *value * ratio::num / ratio::den;
+				if (!fits(count)) {
+					return convError::outOfRange;
+				}
+				return duration(static_cast<Rep>(count));
+			}
+
+			auto value = parseNumber<long long>(number);
+			if (!value) {
+				return value.error();
+			}
+
+			if ((*value > (std::numeric_limits<long long>::max)() / ratio::num) || (*value < (std::numeric_limits<long long>::min)() / ratio::num)) {
+				return convError::outOfRange;
+			}
+
+			const long long count = *value * ratio::num / ratio::den;
+			if (!fits(static_cast<double>(count))) {
+				return convError::outOfRange;
+			}
+			return duration(static_cast<Rep>(count));
+		}
+
+		static bool fits(double count) noexcept {
+			if constexpr (std::is_floating_point_v<Rep>) {
+				return (count >= static_cast<double>(std::numeric_limits<Rep>::lowest())) && (count <= static_cast<double>((std::numeric_limits<Rep>::max)()));
+			}
+			else {
+				// max() + 1 is a power of two, so it is exact as a double
+				return (count >= static_cast<double>(std::numeric_limits<Rep>::lowest())) && (count < static_cast<double>((std::numeric_limits<Rep>::max)()) + 1.0);
+			}
+		}
+	};
+
+	/*!	@brief Byte sizes such as "512", "64KiB", "1.5M" or "2GB"
+	* 
+	*	As with GNU coreutils: K, M, G, T, P and E (in either case, optionally
+	*	followed by "iB") are powers of 1024, while KB, MB, GB ... are powers of
+	*	1000. A trailing "B" on its own means bytes.
+	*/
+	template <>
+	struct option_traits<byteSize>
+	{
+		static convResult<byteSize> parse(std::string_view text) noexcept {
+			if (text.empty()) {
+				return convError::empty;
+			}
+
+			auto length = text.find_first_not_of("+.0123456789");
+			auto number = text.substr(0, length);
+			auto suffix = (length == std::string_view::npos) ? std::string_view{} : text.substr(length);
+			while (!suffix.empty() && (suffix.front() == ' ')) suffix.remove_prefix(1);
+
+			uint64_t multiplier = 1;
+			if (!suffix.empty() && (suffix != "B") && (suffix != "b")) {
+				const auto power = std::string_view("kmgtpe").find(string_utils::to_lower(suffix.front()));
+				suffix.remove_prefix(1);
+
+				uint64_t base = 0;
+				if (suffix.empty() || (suffix == "i") || (suffix == "iB")) {
+					base = 1024;
+				}
+				else if (suffix == "B") {
+					base = 1000;
+				}
+
+				if ((power == std::string_view::npos) || (base == 0)) {
+					return convError::invalid;
+				}
+
+				for (size_t n = 0; n <= power; n++) {
+					multiplier *= base;
+				}
+			}
+
+			if (number.find('.') != std::string_view::npos) {
+				auto value = parseNumber<double>(number);
+				if (!value) {
+					return value.error();
+				}
+
+				// 2^64 is exact as a double
+				const double bytes = *value * static_cast<double>(multiplier);
+				if (bytes >= 18446744073709551616.0) {
+					return convError::outOfRange;
+				}
+				return byteSize{ static_cast<uint64_t>(bytes) };
+			}
+
+			auto value = parseNumber<uint64_t>(number);
+			if (!value) {
+				return value.error();
+			}
+
+			if (*value > (std::numeric_limits<uint64_t>::max)() / multiplier) {
+				return convError::outOfRange;
+			}
+			return byteSize{ *value * multiplier };
+		}
+	};
+
+	/*!	@brief Convert text to @c T without throwing
+	* 
+	*	Spaces around the text are ignored; the rest is converted by
+	*	@c option_traits<T>.
+	*/
+	template <typename T>
+	convResult<T> convertValue(std::string_view text)
+	{
+		while (!text.empty() && (text.front() == ' ')) text.remove_prefix(1);
+		while (!text.empty() && (text.back() == ' ')) text.remove_suffix(1);
+
+		return option_traits<T>::parse(text);
+	}
+
+
+	/*!	@brief Position of the first invalid element of a list option value
+	*/
+	struct listError
+	{
+		size_t index{ 0 };		// element number
+		size_t offset{ 0 };		// character offset of the element in the value
+		size_t length{ 0 };		// length of the element
+	};
+
+	/*!	@brief Converts a delimited list into an array of elements, stored as raw bytes
+	* 
+	*	@return false, if an element could not be converted. See @c listError.
+	*/
+	using listConverter = bool (*)(std::string_view value, char delimiter, std::vector<unsigned char>& elements, listError& error);
+
+	/*!	@brief Read-only view of the converted elements of a list option
+	*/
+	template <typename T>
+	struct listView
+	{
+		const T* data{ nullptr };
+		size_t size{ 0 };
+
+		const T* begin() const noexcept { return data; }
+		const T* end() const noexcept { return data + size; }
+		const T& operator[](size_t n) const noexcept { return data[n]; }
+		bool empty() const noexcept { return size == 0; }
+	};
+
+	/*!	@brief Split the value on the delimiter and convert every element to @c T
+	* 
+	*	Uses @c std::find (memchr) to find each delimiter and @c option_traits<T>
+	*	to convert, so nothing is allocated other than the output array. Spaces
+	*	around an element are ignored.
+	*/
+	template <typename T>
+	bool convertListElements(std::string_view value, char delimiter, std::vector<unsigned char>& elements, listError& error)
+	{
+		static_assert(std::is_trivially_copyable_v<T> && !std::is_same_v<T, std::string_view>, "list options hold numbers, durations, sizes or other trivially copyable elements");
+		static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__, "list elements are stored in an array allocated with the default alignment");
+
+		elements.clear();
+		if (value.find_first_not_of(' ') == std::string_view::npos) {
+			return true;
+		}
+
+		// count the delimiters first, so the output is allocated once
+		const size_t count = static_cast<size_t>(std::count(value.begin(), value.end(), delimiter)) + 1;
+		elements.resize(count * sizeof(T));
+
+		size_t start = 0;
+		for (size_t n = 0; n < count; n++) {
+			size_t end = value.find(delimiter, start);
+			if (end == std::string_view::npos) {
+				end = value.size();
+			}
+
+			auto element = convertValue<T>(value.substr(start, end - start));
+			if (!element) {
+				error.index = n;
+				error.offset = start;
+				error.length = end - start;
+				elements.clear();
+				return false;
+			}
+
+			std::memcpy(elements.data() + n * sizeof(T), &element.value(), sizeof(T));
+			start = end + 1;
+		}
+
+		return true;
+	}
+
+
+	/*!	@brief The kind of value an option holds
+	*/
+	enum class optionKind : uint8_t
+	{
+		value,		// a single string value
+		list,		// a delimited list, see basicCmdParse::add_list_option
+		map,		// key/value pairs, see basicCmdParse::add_map_option
+		flag		// no value, only presence and count, see basicCmdParse::add_flag_option
+	};
+
+
+	/*!	@brief What to do when an option is given more than once
+	*/
+	enum class repeatPolicy : uint8_t
+	{
+		lastWins,		// the last value is kept (default)
+		firstWins,		// the first value is kept, later ones are ignored
+		accumulate		// every value is kept, see basicCmdParse::get_values
+	};
+
+
 	/*!	@brief Encapsulates a command-line option
 	* 
 	*	Basic structure that holds the potential parameter option 
@@ -48,8 +506,8 @@ namespace WGT
 		*   > myapp.exe --BufferSize=1000
 		*   ```
 		*/
-		cmdOption(std::string optionName, std::string defaultValue = "", std::string optionNameShort = "")
-			:longName{ optionName }, shortName{ optionNameShort }, defaultValue{ defaultValue }
+		cmdOption(std::string optionName, std::string optionDefault = "", std::string optionNameShort = "")
+			:longName{ std::move(optionName) }, shortName{ std::move(optionNameShort) }, defaultValue{ std::move(optionDefault) }
 			{
 				if( WGT::string_utils::is_blank(shortName)) {
 					shortName = longName;
@@ -58,322 +516,4327 @@ namespace WGT
 
 		// Ensure that our comparison is case-insensitive
 		bool operator<(const cmdOption & obj) const {
-
-			auto lowercaseA = WGT::string_utils::make_lower(this->longName);
-			auto lowercaseB = WGT::string_utils::make_lower(obj.longName);
-
-			return lowercaseA < lowercaseB;
+			return WGT::string_utils::icompare(this->longName, obj.longName) < 0;
 		}
 
+		/*!	@brief Returns the value converted to @c T
+		* 
+		*	Throws @c std::invalid_argument or @c std::out_of_range if the value
+		*	cannot be converted, or returns @c T{} when built with 
+		*	CMDPARSE_NO_EXCEPTIONS.
+		* 
+		*	@sa option_traits
+		*/
 		template <typename T>
-		T get_value() {
+		T get_value() const {
+			auto result = try_get<T>();
+#ifndef CMDPARSE_NO_EXCEPTIONS
+			if (!result) {
+				if (result.error() == convError::outOfRange) {
+					throw std::out_of_range("value of option '" + longName + "' is out of range");
+				}
+				throw std::invalid_argument("invalid value for option '" + longName + "'");
+			}
+#endif
+			return result.value_or(T{});
+		}
 
-			std::istringstream ss(paramValue);
-			T retVal;
-			ss >> retVal;
-			return retVal;
+		/*!	@brief Convert the value without throwing
+		* 
+		*	@sa convertValue
+		*/
+		template <typename T>
+		convResult<T> try_get() const {
+			return convertValue<T>(paramValue);
 		}
 
-		// Specializations:
-		template<>
-		int get_value<int>()
-		{
-			return std::stoi(paramValue.c_str());
+		bool has_value() const {
+			return !WGT::string_utils::is_blank(paramValue);
+		}
+		
+		bool is_list() const noexcept {
+			return kind == optionKind::list;
 		}
 
-		template<>
-		double get_value<double>()
-		{
-			return std::stod(paramValue.c_str());
+		bool is_map() const noexcept {
+			return kind == optionKind::map;
 		}
 
-		bool has_value() const {
-			return WGT::string_utils::is_blank(paramValue);
+		bool is_flag() const noexcept {
+			return kind == optionKind::flag;
 		}
 		
 		std::string longName{ "" };
 		std::string shortName{ "" };
 		std::string defaultValue{ "" };
 		std::string paramValue{""};
+
+		// List options only, see basicCmdParse::add_list_option
+		listConverter listConvert{ nullptr };
+		std::type_index listType{ typeid(void) };	// element type; the converters of types of one size may be folded by the linker
+		char listDelimiter{ ',' };
+
+		repeatPolicy repeat{ repeatPolicy::lastWins };
+		optionKind kind{ optionKind::value };
 	};
 
 
-	/*!	@brief Command-line options handler class
+	/*!	@brief Append-only storage for interned strings
 	* 
+	*	Every string is stored once in a single contiguous buffer and is
+	*	referred to by a 32-bit offset/length pair. Interning the same text
+	*	twice returns the same reference.
 	*/
-	class cmdParse
+	class stringPool
 	{
 	public:
-		cmdParse() = default;
-		
-		/*!	@brief Alternative constructor that takes preprepared options
-		* 
-		*   Example:
-		*	```cpp
-		*	cmdParse cmd( { {"optionA", "10", "a"}, {"backColour", "#FFFFFF", "b"} } );
-		*	cmd.init(argc, argv);
-		*	```
+		struct ref
+		{
+			uint32_t offset{ 0 };
+			uint32_t length{ 0 };
+		};
+
+		stringPool() = default;
+
+		/*!	@brief Store the given text (if not already present) and return its reference
 		*/
-		cmdParse(std::vector<cmdOption> optionVec) noexcept {
-			for (auto& o : optionVec) {
-				add_param_option(o);
+		ref intern(std::string_view str) {
+			
+			if (str.empty()) {
+				return {};
 			}
-		}
 
-		/*!	@brief Initialize the command-line handler with the arguments given to the application
-		* 
-		*	Before calling, please add all the options that are to be supported by the application.
-		* 
-		*   Example:
-		*   ```cpp
-		*   int main(int argc, char *argv[])
-		*   {
-		*		cmdParse cmd;
-		* 
-		*		// Add supported options
-		*       cmd.add_param_option(cmdOption("BufferSize", "1000", 'b'));
-		*       cmd.add_param_option(cmdOption("OutputFile", "output.txt", 'o'));
-		* 
-		*		// Initialize with arguments
-		*       cmd.init(argc, argv);
-		*   }
-		*   ```
-		* 
-		*/
-		bool init(int argc, const char* argv[]) { 
-			if((argc <= 0) ) {
-				logError("No arguments given to application");
-				return false;
+			// keep the load factor below 1/2
+			if ((m_count + 1) * 2 > m_slots.size()) {
+				rehash(m_slots.empty() ? 64 : m_slots.size() * 2);
 			}
 
-			m_executable_name = argv[0];
+			const size_t mask = m_slots.size() - 1;
+			for (size_t n = hash(str) & mask; ; n = (n + 1) & mask) {
+				auto& slot = m_slots[n];
+				if (slot.length == 0) {
+					assert(m_buffer.size() + str.size() <= (std::numeric_limits<uint32_t>::max)());
+					slot.offset = static_cast<uint32_t>(m_buffer.size());
+					slot.length = static_cast<uint32_t>(str.size());
+					m_buffer.append(str.data(), str.size());
+					m_count++;
+					return slot;
+				}
 
-			for(int n = 1; n < argc; n++) {
-				
-				std::string arg_str = argv[n];
-				WGT::string_utils::trim(arg_str);
-				m_arguments.push_back(arg_str);
+				if (view(slot) == str) {
+					return slot;
+				}
 			}
-
-			return parseOptions();
 		}
 
-		/*!	@brief Returns the list of arguments that was supplied to the application
+		/*!	@brief Returns the text of a reference obtained from @c intern()
 		* 
-		*   This does not include the name of the client executable.
+		*	The view is invalidated by the next call to @c intern().
 		*/
-		std::vector<std::string> get_arguments() noexcept {
-			return m_arguments;
+		std::string_view view(ref r) const noexcept {
+			return std::string_view(m_buffer.data() + r.offset, r.length);
 		}
 
-		/*!	@brief Add a command-line option that the application will support
-		* 
-		*	@return false, if unable to set option. This could be due to 
-		*   conflict in the option name provided. Check any reported errors if false.
-		* 
-		*	@sa get_errors
+		/*!	@brief Number of bytes of text held by the pool
 		*/
-		bool add_param_option(cmdOption paramOption) {
-			
-			auto result = m_parameter_options.insert(paramOption);
-			if(!result.second) {
-				logError("Option already exists: " + paramOption.longName);
-			}
-
-			return result.second;
+		size_t size() const noexcept {
+			return m_buffer.size();
 		}
 
-		/*!	@brief Returns the number of command-line options that have been added
-		* 
-		*	Use @c add_param_option() to add more options to the handler.
-		* 
-		*	@sa add_param_option
-		*	@sa has_param_option
+		/*!	@brief Bytes allocated for text and the interning table
 		*/
-		int get_param_option_count() const noexcept {
-			return static_cast<int>(m_parameter_options.size());
+		size_t capacity_bytes() const noexcept {
+			return m_buffer.capacity() + m_slots.capacity() * sizeof(ref);
 		}
 
-		/*!	@brief Test if a command-line option has been set
-		*/
-		bool has_param_option(std::string optionName) const {
-			
-			auto itF = m_parameter_options.find(cmdOption(optionName));
-			if(itF == m_parameter_options.end()) {
-				return false;
-			}
+		void reserve(size_t bytes) {
+			m_buffer.reserve(bytes);
+		}
 
-			return true;
+		/*!	@brief All of the text, back to back, as referred to by the references
+		*/
+		std::string_view data() const noexcept {
+			return m_buffer;
+		}
+
+	private:
+		std::string m_buffer;
+		std::vector<ref> m_slots;	// open addressing, length 0 marks an empty slot
+		size_t m_count{ 0 };
+
+		static size_t hash(std::string_view str) noexcept {
+			// FNV-1a
+			uint64_t h = 14695981039346656037ull;
+			for (char c : str) {
+				h ^= static_cast<unsigned char>(c);
+				h *= 1099511628211ull;
+			}
+			return static_cast<size_t>(h);
+		}
+
+		void rehash(size_t slotCount) {
+			std::vector<ref> old;
+			old.swap(m_slots);
+			m_slots.resize(slotCount);
+
+			const size_t mask = slotCount - 1;
+			for (auto& r : old) {
+				if (r.length == 0) continue;
+				size_t n = hash(view(r)) & mask;
+				while (m_slots[n].length != 0) {
+					n = (n + 1) & mask;
+				}
+				m_slots[n] = r;
+			}
+		}
+	};
+
+
+	/*!	@brief Compact (POD) record of a command-line option
+	* 
+	*	Holds references into the strings of a @c compactOptionTable rather than 
+	*	owning any strings.
+	*/
+	struct compactOption
+	{
+		stringPool::ref longName;
+		stringPool::ref shortName;
+		stringPool::ref defaultValue;
+		stringPool::ref paramValue;		// in the value text, not the pool
+		optionKind kind;
+		repeatPolicy repeat;
+		bool hasValue;
+		uint8_t reserved;
+	};
+
+	static_assert(sizeof(compactOption) == 36, "compactOption should remain a small POD record");
+
+
+	/*!	@brief Compact storage of the options of a @c basicCmdParse
+	* 
+	*	The names and default values are interned into one @c stringPool, and 
+	*	each option is a 36 byte @c compactOption record, in order of 
+	*	registration. Parsed values are kept apart, in text that is cleared 
+	*	with @c clear_values() before each parse. The short names are hashed; 
+	*	the long names are indexed by the parser, which sorts them once per batch.
+	* 
+	*   Example:
+	*	```cpp
+	*	compactOptionTable table;
+	*	auto id = table.add(cmdOption("BufferSize", "1000", "b"));
+	*	table.set_value(table.find_short("b"), "23");
+	*	```
+	*/
+	class compactOptionTable
+	{
+	public:
+		static constexpr int npos = -1;
+
+		/*!	@brief The fields of one option, as views of the table's text
+		* 
+		*	The names are valid until the next @c add(), the value until the 
+		*	next @c set_value() or @c clear_values().
+		*/
+		struct optionView
+		{
+			std::string_view longName;
+			std::string_view shortName;
+			std::string_view defaultValue;
+			std::string_view paramValue;
+			optionKind kind;
+			repeatPolicy repeat;
+
+			bool is_list() const noexcept { return kind == optionKind::list; }
+			bool is_map() const noexcept { return kind == optionKind::map; }
+			bool is_flag() const noexcept { return kind == optionKind::flag; }
+		};
+
+		compactOptionTable() = default;
+
+		/*!	@brief Add an option to the table, with no value
+		* 
+		*	The name is not checked against the other options, see 
+		*	basicCmdParse::add_param_option. Of the options that share a short
+		*	name, @c find_short() returns the first.
+		* 
+		*	@return the id of the option
+		*/
+		uint32_t add(const cmdOption& option) {
+			compactOption record{};
+			record.longName = m_pool.intern(option.longName);
+			record.shortName = m_pool.intern(option.shortName);
+			record.defaultValue = m_pool.intern(option.defaultValue);
+			record.kind = option.kind;
+			record.repeat = option.repeat;
+
+			const auto id = static_cast<uint32_t>(m_records.size());
+			m_records.push_back(record);
+
+			// keep the load factor below 1/2
+			if (m_records.size() * 2 > m_short_slots.size()) {
+				rehashShortNames(m_short_slots.empty() ? 64 : m_short_slots.size() * 2);
+			}
+			else {
+				insertShortName(id);
+			}
+
+			if (!option.paramValue.empty()) {
+				set_value(id, option.paramValue);
+			}
+			return id;
+		}
+
+		/*!	@brief Returns the id of the first option with the given short name
+		* 
+		*	@return npos if not found
+		*/
+		int find_short(std::string_view shortName) const noexcept {
+			if (m_short_slots.empty()) {
+				return npos;
+			}
+
+			const size_t mask = m_short_slots.size() - 1;
+			for (size_t n = hash_utils::hash(shortName, 0, false) & mask; m_short_slots[n] != 0; n = (n + 1) & mask) {
+				const auto id = m_short_slots[n] - 1;
+				if (short_name(id) == shortName) {
+					return static_cast<int>(id);
+				}
+			}
+
+			return npos;
+		}
+
+		/*!	@brief Set the parsed value of the option
+		* 
+		*	A value that fits is written over the one it replaces; otherwise it 
+		*	is appended, and once most of the text is unused it is compacted.
+		*/
+		void set_value(uint32_t id, std::string_view value) {
+			assert(id < m_records.size());
+			auto& record = m_records[id];
+			if (!record.hasValue) {
+				record.hasValue = true;
+				m_given.push_back(id);
+			}
+			else if (value.size() <= record.paramValue.length) {
+				m_unused += record.paramValue.length - value.size();
+				std::copy(value.begin(), value.end(), m_values.begin() + record.paramValue.offset);
+				record.paramValue.length = static_cast<uint32_t>(value.size());
+				return;
+			}
+			else {
+				m_unused += record.paramValue.length;
+			}
+
+			assert(m_values.size() + value.size() <= (std::numeric_limits<uint32_t>::max)());
+			record.paramValue.offset = static_cast<uint32_t>(m_values.size());
+			record.paramValue.length = static_cast<uint32_t>(value.size());
+			m_values.append(value.data(), value.size());
+			compactValues();
+		}
+
+		/*!	@brief Clear the values of every option, ready for the next parse
+		* 
+		*	Only the options given a value since the last call are visited.
+		*/
+		void clear_values() noexcept {
+			for (auto id : m_given) {
+				m_records[id].paramValue = {};
+				m_records[id].hasValue = false;
+			}
+			m_given.clear();
+			m_values.clear();
+			m_unused = 0;
+		}
+
+		void set_repeat(uint32_t id, repeatPolicy policy) noexcept {
+			assert(id < m_records.size());
+			m_records[id].repeat = policy;
+		}
+
+		optionView operator[](uint32_t id) const noexcept {
+			assert(id < m_records.size());
+			auto& record = m_records[id];
+			return { m_pool.view(record.longName), m_pool.view(record.shortName), m_pool.view(record.defaultValue),
+				value(id), record.kind, record.repeat };
+		}
+
+		std::string_view long_name(uint32_t id) const noexcept { return m_pool.view(m_records[id].longName); }
+		std::string_view short_name(uint32_t id) const noexcept { return m_pool.view(m_records[id].shortName); }
+		std::string_view default_value(uint32_t id) const noexcept { return m_pool.view(m_records[id].defaultValue); }
+		std::string_view value(uint32_t id) const noexcept {
+			auto r = m_records[id].paramValue;
+			return std::string_view(m_values.data() + r.offset, r.length);
+		}
+
+		/*!	@brief Returns a full @c cmdOption copy of the given option
+		* 
+		*	The list fields are not kept in the table, and are left as default.
+		*/
+		cmdOption get_option(uint32_t id) const {
+			auto o = (*this)[id];
+			cmdOption option(std::string(o.longName), std::string(o.defaultValue), std::string(o.shortName));
+			option.paramValue = o.paramValue;
+			option.kind = o.kind;
+			option.repeat = o.repeat;
+			return option;
+		}
+
+		uint32_t size() const noexcept {
+			return static_cast<uint32_t>(m_records.size());
+		}
+
+		/*!	@brief Approximate number of bytes allocated by the table
+		*/
+		size_t memory_usage() const noexcept {
+			return m_pool.capacity_bytes()
+				+ m_records.capacity() * sizeof(compactOption)
+				+ m_short_slots.capacity() * sizeof(uint32_t)
+				+ m_values.capacity() + m_given.capacity() * sizeof(uint32_t);
+		}
+
+		/*!	@brief Reserve room for the given number of options, and for @c textBytes more bytes of names
+		*/
+		void reserve(size_t optionCount, size_t textBytes = 0) {
+			m_records.reserve(optionCount);
+			m_pool.reserve(m_pool.size() + textBytes);
+		}
+
+	private:
+		stringPool m_pool;						// names and default values
+		std::vector<compactOption> m_records;	// in order of registration
+		std::vector<uint32_t> m_short_slots;	// open addressing, id + 1, 0 marks an empty slot
+
+		std::string m_values;					// parsed values, back to back
+		std::vector<uint32_t> m_given;			// ids of the options with a value
+		size_t m_unused{ 0 };					// bytes of m_values that were replaced
+
+		void insertShortName(uint32_t id) noexcept {
+			const auto shortName = short_name(id);
+			const size_t mask = m_short_slots.size() - 1;
+			for (size_t n = hash_utils::hash(shortName, 0, false) & mask; ; n = (n + 1) & mask) {
+				if (m_short_slots[n] == 0) {
+					m_short_slots[n] = id + 1;
+					return;
+				}
+				if (short_name(m_short_slots[n] - 1) == shortName) {
+					return;
+				}
+			}
+		}
+
+		void rehashShortNames(size_t slotCount) {
+			m_short_slots.assign(slotCount, 0);
+			for (uint32_t id = 0; id < m_records.size(); id++) {
+				insertShortName(id);
+			}
+		}
+
+		void compactValues() {
+			if ((m_unused < 1024) || (m_unused * 2 < m_values.size())) {
+				return;
+			}
+
+			std::string values;
+			values.reserve(m_values.size() - m_unused);
+			for (auto id : m_given) {
+				auto& r = m_records[id].paramValue;
+				const auto from = r.offset;
+				r.offset = static_cast<uint32_t>(values.size());
+				values.append(m_values, from, r.length);
+			}
+			m_values.swap(values);
+			m_unused = 0;
+		}
+	};
+
+
+	/*!	@brief Kinds of error reported by @c basicCmdParse
+	*/
+	enum class errorCode : uint8_t
+	{
+		noArguments,			// init() was given no arguments
+		optionExists,			// an option with the same name was already added
+		optionsFrozen,			// an option was added after freeze()
+		shortNameReused,		// freeze() found a short name used by more than one option
+		lookupTableFailed,		// freeze() could not build the lookup tables
+		optionNotFound,			// the command-line has an unknown option
+		invalidListElement,		// a list element could not be converted
+		missingMapKey,			// a map option was given without a key
+		invalidFlagValue,		// a flag was given a value that is not a boolean
+		subcommandExists,		// a subcommand with the same name was already added
+		subcommandNotFound,		// the command-line names an unknown subcommand
+		unexpectedArgument		// override_options() was given an argument that is not an option
+	};
+
+	/*!	@brief Compact record of an error
+	* 
+	*	Nothing is formatted when an error is recorded; the message text is only
+	*	built when asked for, see basicCmdParse::format_error.
+	*/
+	struct cmdError
+	{
+		errorCode code;
+		int32_t optionId;		// option the error relates to, or -1
+		int32_t argIndex;		// index in argv of the argument, or -1
+		uint32_t index;			// invalidListElement: element number
+		uint32_t position;		// invalidListElement: offset of the element in the value
+		uint32_t textOffset;	// related text (e.g. the unknown option name),
+		uint32_t textLength;	// stored in the handler's error text buffer
+	};
+
+
+	/*!	@brief How basicCmdParse::write_argv writes the options
+	*/
+	struct argvStyle
+	{
+		bool shortNames{ false };	// -b=1000 rather than --BufferSize=1000
+		char separator{ '=' };		// between the name and the value
+		bool quoteSpaces{ false };	// quote arguments with blanks or quotes by quoteRules::windows, to join them into one command-line
+		bool allOptions{ false };	// also write options that were not given, with their default value
+	};
+
+	/*!	@brief An argv array written by basicCmdParse::write_argv
+	*/
+	struct argvBuffer
+	{
+		const char* const* argv{ nullptr };	// null-terminated; nullptr if the buffer was too small
+		int argc{ 0 };
+		size_t size{ 0 };					// bytes of buffer needed
+		std::string_view unreadable;		// an option whose value would not be read back (see write_argv), else empty
+	};
+
+	/*!	@brief Quoting rules for basicCmdParse::init_from_string
+	*/
+	enum class quoteRules : uint8_t
+	{
+		windows,	// as the Microsoft C runtime and CommandLineToArgvW split a command-line
+		posix		// as a POSIX shell quotes words, without any expansions
+	};
+
+	/*!	@brief Splits a whole command-line into arguments, in place
+	* 
+	*	The text is modified: each argument is ended with a null character, 
+	*	and arguments with quotes or escapes are unescaped where they are 
+	*	(an unescaped argument is never longer). So arguments without them 
+	*	are used as they are, and nothing is allocated but the pointer array.
+	* 
+	*	The quote, backslash and white space characters are found 16 bytes at
+	*	a time with SSE2, where it is available.
+	* 
+	*	quoteRules::windows :
+	*	- arguments are separated by spaces and tabs; "..." quotes them
+	*	- 2n backslashes and a quote give n backslashes, and the quote begins
+	*	  or ends quoting; 2n+1 backslashes and a quote give n backslashes and 
+	*	  a literal quote; other backslashes are literal
+	*	- "" within quotes gives a literal quote (as the C runtime since 2008)
+	*	- the first argument (the program) ends at white space, or is quoted,
+	*	  and has no escapes
+	* 
+	*	quoteRules::posix :
+	*	- arguments are separated by spaces, tabs and new lines
+	*	- '...' quotes everything up to the next single quote
+	*	- "..." quotes, where a backslash only escapes \ " $ ` and new line
+	*	- otherwise a backslash escapes the next character
+	*	- a backslash and new line are removed
+	* 
+	*	An unterminated quote runs to the end of the text.
+	*/
+	class cmdLineTokenizer
+	{
+	public:
+		/*!	@brief Split @c text, filling @c argv with pointers into it, followed by nullptr
+		* 
+		*	@param programName the first argument is the program, for quoteRules::windows
+		*/
+		static void split(std::string& text, quoteRules rules, std::vector<const char*>& argv, bool programName = true) {
+			argv.clear();
+			const size_t end = text.size();
+			text.push_back('\0');
+			char* s = &text[0];
+
+			size_t i = 0;
+			for (;;) {
+				while ((i < end) && isBlank(s[i], rules)) {
+					i++;
+				}
+				if (i >= end) {
+					break;
+				}
+
+				size_t start = i;
+				size_t next;
+				if (programName && argv.empty() && (rules == quoteRules::windows)) {
+					next = programEnd(s, start, end);
+				}
+				else {
+					next = i + findSpecial(s + i, end - i, rules);
+					if ((next < end) && !isBlank(s[next], rules)) {
+						next = (rules == quoteRules::windows) ? unescapeWindows(s, next, end) : unescapePosix(s, next, end);
+					}
+					else {
+						s[next] = '\0';
+					}
+				}
+
+				argv.push_back(s + start);
+				i = next + 1;
+			}
+
+			argv.push_back(nullptr);
+		}
+
+	private:
+		static constexpr bool isBlank(char c, quoteRules rules) noexcept {
+			return (c == ' ') || (c == '\t') || ((c == '\n') && (rules == quoteRules::posix));
+		}
+
+		static constexpr bool isSpecial(char c, quoteRules rules) noexcept {
+			return isBlank(c, rules) || (c == '"') || (c == '\\') || ((c == '\'') && (rules == quoteRules::posix));
+		}
+
+		// offset of the first blank, quote or backslash, or size if there are none
+		static size_t findSpecial(const char* p, size_t size, quoteRules rules) noexcept {
+			size_t n = 0;
+#ifdef CMDPARSE_SSE2
+			const __m128i space = _mm_set1_epi8(' ');
+			const __m128i tab = _mm_set1_epi8('\t');
+			const __m128i quote = _mm_set1_epi8('"');
+			const __m128i backslash = _mm_set1_epi8('\\');
+			const __m128i newline = _mm_set1_epi8((rules == quoteRules::posix) ? '\n' : ' ');
+			const __m128i single = _mm_set1_epi8((rules == quoteRules::posix) ? '\'' : ' ');
+			for (; n + 16 <= size; n += 16) {
+				const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + n));
+				__m128i found = _mm_or_si128(_mm_cmpeq_epi8(block, space), _mm_cmpeq_epi8(block, tab));
+				found = _mm_or_si128(found, _mm_or_si128(_mm_cmpeq_epi8(block, quote), _mm_cmpeq_epi8(block, backslash)));
+				found = _mm_or_si128(found, _mm_or_si128(_mm_cmpeq_epi8(block, newline), _mm_cmpeq_epi8(block, single)));
+				const auto mask = static_cast<unsigned>(_mm_movemask_epi8(found));
+				if (mask != 0) {
+#ifdef _MSC_VER
+					unsigned long bit;
+					_BitScanForward(&bit, mask);
+					return n + bit;
+#else
+					return n + static_cast<size_t>(__builtin_ctz(mask));
+#endif
+				}
+			}
+#endif
+			for (; n < size; n++) {
+				if (isSpecial(p[n], rules)) {
+					break;
+				}
+			}
+			return n;
+		}
+
+		// copy the characters up to the next special one, returns the new read position
+		static size_t copyRun(char* s, size_t r, size_t end, size_t& w, quoteRules rules) noexcept {
+			const size_t length = (std::max)(findSpecial(s + r, end - r, rules), size_t(1));
+			std::memmove(s + w, s + r, length);
+			w += length;
+			return r + length;
+		}
+
+		static size_t programEnd(char* s, size_t start, size_t end) noexcept {
+			size_t next;
+			if (s[start] == '"') {
+				auto close = static_cast<const char*>(std::memchr(s + start + 1, '"', end - start - 1));
+				next = (close != nullptr) ? static_cast<size_t>(close - s) : end;
+				std::memmove(s + start, s + start + 1, next - start - 1);
+				s[next - 1] = '\0';
+				return next;
+			}
+
+			next = start;
+			while ((next < end) && !isBlank(s[next], quoteRules::windows)) {
+				next++;
+			}
+			s[next] = '\0';
+			return next;
+		}
+
+		// unescape from r, the first quote or backslash; returns where the argument ended
+		static size_t unescapeWindows(char* s, size_t r, size_t end) noexcept {
+			size_t w = r;
+			bool quoted = false;
+			while (r < end) {
+				const char c = s[r];
+				if (c == '\\') {
+					size_t count = 0;
+					while ((r + count < end) && (s[r + count] == '\\')) {
+						count++;
+					}
+
+					const bool beforeQuote = (s[r + count] == '"');
+					const size_t kept = beforeQuote ? count / 2 : count;
+					std::memset(s + w, '\\', kept);
+					w += kept;
+					r += count;
+					if (beforeQuote && (count % 2 != 0)) {
+						s[w++] = '"';
+						r++;
+					}
+				}
+				else if (c == '"') {
+					if (quoted && (s[r + 1] == '"')) {
+						s[w++] = '"';
+						r += 2;
+					}
+					else {
+						quoted = !quoted;
+						r++;
+					}
+				}
+				else if (!quoted && isBlank(c, quoteRules::windows)) {
+					break;
+				}
+				else {
+					r = copyRun(s, r, end, w, quoteRules::windows);
+				}
+			}
+
+			s[w] = '\0';
+			return r;
+		}
+
+		static size_t unescapePosix(char* s, size_t r, size_t end) noexcept {
+			size_t w = r;
+			char quote = 0;
+			while (r < end) {
+				const char c = s[r];
+				if (quote == '\'') {
+					if (c == '\'') {
+						quote = 0;
+						r++;
+					}
+					else {
+						auto close = static_cast<const char*>(std::memchr(s + r, '\'', end - r));
+						const size_t length = ((close != nullptr) ? static_cast<size_t>(close - s) : end) - r;
+						std::memmove(s + w, s + r, length);
+						w += length;
+						r += length;
+					}
+				}
+				else if (c == '\\') {
+					const char next = s[r + 1];		// the text ends with a null
+					if (next == '\n') {
+						r += 2;
+					}
+					else if ((quote == '"') && (next != '\\') && (next != '"') && (next != '$') && (next != '`')) {
+						s[w++] = c;
+						r++;
+					}
+					else if (r + 1 < end) {
+						s[w++] = next;
+						r += 2;
+					}
+					else {
+						r++;
+					}
+				}
+				else if ((c == '"') || ((c == '\'') && (quote == 0))) {
+					quote = (quote == c) ? 0 : c;
+					r++;
+				}
+				else if ((quote == 0) && isBlank(c, quoteRules::posix)) {
+					break;
+				}
+				else {
+					r = copyRun(s, r, end, w, quoteRules::posix);
+				}
+			}
+
+			s[w] = '\0';
+			return r;
+		}
+	};
+
+	/*!	@brief An occurrence count as an int, for counts beyond INT_MAX
+	*/
+	inline int clampCount(uint32_t count) noexcept {
+		return static_cast<int>((std::min)(count, static_cast<uint32_t>((std::numeric_limits<int>::max)())));
+	}
+
+	/*!	@brief Read-only view of a parse result written by basicCmdParse::write_snapshot
+	* 
+	*	A snapshot is one position-independent block of memory: a header, a
+	*	record per option, hash tables of the long and short names, and the
+	*	text of every string (each stored once). Everything is referred to by
+	*	offsets from the start of the block, so the block can be written to a
+	*	file or shared memory, mapped by another process at any address, and
+	*	queried in place: nothing is parsed, copied or allocated.
+	* 
+	*	The block must be 4-byte aligned, and is in the byte order of the 
+	*	machine that wrote it. If the command-line had a subcommand, its 
+	*	parse is a snapshot of its own, nested in the block.
+	* 
+	*   Example:
+	*	```cpp
+	*	cmdSnapshot config(mapped, mappedSize);
+	*	if (config.is_valid()) {
+	*		auto size = config.try_get<int>("BufferSize");
+	*	}
+	*	```
+	*/
+	class cmdSnapshot
+	{
+	public:
+		static constexpr int npos = -1;
+		static constexpr uint32_t magic = 0x53444d43;	// "CMDS"
+		static constexpr uint32_t version = 3;
+		static constexpr uint32_t ignoreCaseFlag = 1;
+
+		struct header
+		{
+			uint32_t magic;
+			uint32_t version;
+			uint32_t flags;
+			uint32_t size;				// of the whole snapshot, in bytes
+			uint32_t optionCount;
+			uint32_t slotCount;			// of each hash table, a power of two
+			uint32_t positionalCount;
+			uint32_t recordsOffset;
+			uint32_t longSlotsOffset;	// slot -> option index + 1, or 0 if empty
+			uint32_t shortSlotsOffset;
+			uint32_t positionalsOffset;	// stringPool::ref of each positional argument
+			uint32_t textOffset;
+			uint32_t textSize;
+			stringPool::ref subcommandName;
+			uint32_t subcommandOffset;	// of the subcommand's own snapshot, if subcommandSize is not 0
+			uint32_t subcommandSize;
+		};
+
+		struct record
+		{
+			stringPool::ref longName;
+			stringPool::ref shortName;
+			stringPool::ref defaultValue;
+			stringPool::ref value;			// given on the command-line
+			uint8_t kind;					// optionKind
+			uint8_t reserved[3];
+			uint32_t count;					// number of times given
+		};
+
+		cmdSnapshot() = default;
+
+		/*!	@brief View the snapshot at @c data
+		* 
+		*	Only the header is checked here; every offset is checked when used.
+		*/
+		cmdSnapshot(const void* data, size_t size) noexcept {
+			if ((data == nullptr) || (size < sizeof(header)) || ((reinterpret_cast<uintptr_t>(data) % alignof(uint32_t)) != 0)) {
+				return;
+			}
+
+			header h;
+			std::memcpy(&h, data, sizeof(h));
+			const uint64_t tableEnd = static_cast<uint64_t>(h.slotCount) * sizeof(uint32_t);
+			const bool valid = (h.magic == magic) && (h.version == version) && (h.size <= size)
+				&& (h.slotCount != 0) && ((h.slotCount & (h.slotCount - 1)) == 0) && (h.slotCount > h.optionCount)
+				&& (h.recordsOffset + static_cast<uint64_t>(h.optionCount) * sizeof(record) <= h.size)
+				&& (h.longSlotsOffset + tableEnd <= h.size) && (h.shortSlotsOffset + tableEnd <= h.size)
+				&& (h.positionalsOffset + static_cast<uint64_t>(h.positionalCount) * sizeof(stringPool::ref) <= h.size)
+				&& (static_cast<uint64_t>(h.textOffset) + h.textSize <= h.size)
+				&& (static_cast<uint64_t>(h.subcommandOffset) + h.subcommandSize <= h.size);
+			if (valid) {
+				m_data = static_cast<const unsigned char*>(data);
+				m_header = h;
+			}
+		}
+
+		bool is_valid() const noexcept {
+			return m_data != nullptr;
+		}
+
+		size_t get_param_option_count() const noexcept {
+			return m_header.optionCount;
+		}
+
+		/*!	@brief Returns the index of the option with the given long name, or npos
+		*/
+		int get_option_id(std::string_view optionName) const noexcept {
+			return find(optionName, false);
+		}
+
+		bool has_param_option(std::string_view optionName) const noexcept {
+			return find(optionName, false) != npos;
+		}
+
+		/*!	@brief Returns the value given on the command-line, or the default value if it was not given
+		* 
+		*	The view points into the snapshot.
+		*/
+		std::string_view get_value(std::string_view optionName) const noexcept {
+			auto id = find(optionName, false);
+			if (id == npos) {
+				return {};
+			}
+
+			auto r = getRecord(static_cast<uint32_t>(id));
+			return text((r.count != 0) ? r.value : r.defaultValue);
+		}
+
+		/*!	@brief Returns the value of the option with the given short name, as @c get_value()
+		*/
+		std::string_view get_value_short(std::string_view shortName) const noexcept {
+			auto id = find(shortName, true);
+			if (id == npos) {
+				return {};
+			}
+
+			auto r = getRecord(static_cast<uint32_t>(id));
+			return text((r.count != 0) ? r.value : r.defaultValue);
+		}
+
+		/*!	@brief Returns the value converted to @c T, as basicCmdParse::try_get
+		*/
+		template <typename T>
+		convResult<T> try_get(std::string_view optionName) const {
+			if (find(optionName, false) == npos) {
+				return convError::unknownOption;
+			}
+			return convertValue<T>(get_value(optionName));
+		}
+
+		int get_occurrence_count(std::string_view optionName) const noexcept {
+			auto id = find(optionName, false);
+			return (id == npos) ? 0 : clampCount(getRecord(static_cast<uint32_t>(id)).count);
+		}
+
+		/*!	@brief Returns the long name, short name, default value and value of an option by index
+		*/
+		record get_record(uint32_t id) const noexcept {
+			return (id < m_header.optionCount) ? getRecord(id) : record{};
+		}
+
+		/*!	@brief Returns the text that a reference of a record refers to
+		*/
+		std::string_view text(stringPool::ref r) const noexcept {
+			if (!is_valid() || (static_cast<uint64_t>(r.offset) + r.length > m_header.textSize)) {
+				return {};
+			}
+			return std::string_view(reinterpret_cast<const char*>(m_data + m_header.textOffset + r.offset), r.length);
+		}
+
+		/*!	@brief Returns the name of the subcommand on the command-line, or an empty string
+		*/
+		std::string_view get_subcommand_name() const noexcept {
+			return text(m_header.subcommandName);
+		}
+
+		/*!	@brief Returns the snapshot of the subcommand's parse (not valid, if there was no subcommand)
+		*/
+		cmdSnapshot get_subcommand() const noexcept {
+			if (!is_valid() || (m_header.subcommandSize == 0)) {
+				return {};
+			}
+			return cmdSnapshot(m_data + m_header.subcommandOffset, m_header.subcommandSize);
+		}
+
+		size_t get_positional_count() const noexcept {
+			return m_header.positionalCount;
+		}
+
+		std::string_view get_positional(size_t n) const noexcept {
+			if (n >= m_header.positionalCount) {
+				return {};
+			}
+
+			stringPool::ref r;
+			std::memcpy(&r, m_data + m_header.positionalsOffset + n * sizeof(r), sizeof(r));
+			return text(r);
+		}
+
+	private:
+		const unsigned char* m_data{ nullptr };
+		header m_header{};
+
+		record getRecord(uint32_t id) const noexcept {
+			record r;
+			std::memcpy(&r, m_data + m_header.recordsOffset + static_cast<size_t>(id) * sizeof(record), sizeof(r));
+			return r;
+		}
+
+		int find(std::string_view name, bool shortName) const noexcept {
+			if (!is_valid() || (m_header.optionCount == 0)) {
+				return npos;
+			}
+
+			// short names always match case, as in basicCmdParse
+			const bool ignoreCase = !shortName && ((m_header.flags & ignoreCaseFlag) != 0);
+			const uint32_t table = shortName ? m_header.shortSlotsOffset : m_header.longSlotsOffset;
+			const uint32_t mask = m_header.slotCount - 1;
+
+			// there is always an empty slot, but a snapshot that is being overwritten 
+			// (see sharedSnapshot) may not have one, so stop after one pass
+			auto n = static_cast<uint32_t>(hash_utils::hash(name, 0, ignoreCase)) & mask;
+			for (uint32_t probe = 0; probe < m_header.slotCount; probe++, n = (n + 1) & mask) {
+				uint32_t slot;
+				std::memcpy(&slot, m_data + table + static_cast<size_t>(n) * sizeof(slot), sizeof(slot));
+				if ((slot == 0) || (slot > m_header.optionCount)) {
+					return npos;
+				}
+
+				auto r = getRecord(slot - 1);
+				auto key = text(shortName ? r.shortName : r.longName);
+				if (ignoreCase ? string_utils::iequals(key, name) : (key == name)) {
+					return static_cast<int>(slot - 1);
+				}
+			}
+
+			return npos;
+		}
+	};
+
+	static_assert(sizeof(cmdSnapshot::header) == 68, "snapshot header should have no padding");
+	static_assert(sizeof(cmdSnapshot::record) == 40, "snapshot record should have no padding");
+
+
+	/*!	@brief Snapshots in a named shared memory segment, for a parent process and its workers
+	* 
+	*	The parent creates the segment and publishes a snapshot of its parse 
+	*	(see basicCmdParse::write_snapshot); the workers open the segment by 
+	*	name and query it. Publishing again (e.g. after a reload) makes a new
+	*	generation, which the workers see on their next lookup.
+	* 
+	*	The segment holds two snapshots: the current generation, and the one
+	*	being written. Each slot has a sequence number (a seqlock), which is 
+	*	odd while the slot is being written. Lookups read the generation 
+	*	number and the sequence of its slot, query that snapshot, and check 
+	*	that the sequence was even and has not moved on; if not, the lookup is
+	*	simply repeated. So lookups never make a system call or take a lock, 
+	*	and never see a half-written snapshot. Values are returned as copies,
+	*	since the text of an old generation is overwritten.
+	* 
+	*	There must be a single writer: only one thread, in one process, may 
+	*	call @c publish().
+	* 
+	*	Workers look options up by name, one at a time; for anything else in
+	*	the snapshot (e.g. positionals, or the subcommand) call @c read() 
+	*	with the cmdSnapshot accessors.
+	* 
+	*   Example:
+	*	```cpp
+	*	// parent
+	*	auto shared = sharedSnapshot::create("MyServerConfig", 64 * 1024);
+	*	shared.publish(cmd);
+	* 
+	*	// worker
+	*	auto shared = sharedSnapshot::open("MyServerConfig");
+	*	auto size = shared.try_get<int>("BufferSize");
+	*	```
+	*/
+	class sharedSnapshot
+	{
+	public:
+		sharedSnapshot() = default;
+
+		sharedSnapshot(const sharedSnapshot&) = delete;
+		sharedSnapshot& operator=(const sharedSnapshot&) = delete;
+
+		sharedSnapshot(sharedSnapshot&& other) noexcept {
+			swap(other);
+		}
+
+		sharedSnapshot& operator=(sharedSnapshot&& other) noexcept {
+			if (this != &other) {
+				close();
+				swap(other);
+			}
+			return *this;
+		}
+
+		~sharedSnapshot() {
+			close();
+		}
+
+		/*!	@brief Create the segment, with room for snapshots of up to @c capacity bytes
+		* 
+		*	@c name must be a valid name for a file mapping (Windows) or 
+		*	shm_open (POSIX, e.g. "/MyServerConfig"). The segment is removed when 
+		*	the creator closes it; workers that already have it open keep it.
+		*	On POSIX a segment of the same name that is still there, e.g. left
+		*	by a creator that crashed, is removed and made again.
+		*/
+		static sharedSnapshot create(const std::string& name, size_t capacity) {
+			sharedSnapshot shared;
+			capacity = (capacity + slotAlignment - 1) & ~(slotAlignment - 1);
+			if ((capacity == 0) || (capacity > (std::numeric_limits<uint32_t>::max)())) {
+				return shared;
+			}
+
+			const size_t size = headerSize + 2 * capacity;
+			if (!shared.map(name, size, true)) {
+				return shared;
+			}
+
+			// the generation goes last, so a worker never sees a partly set up header
+			auto h = shared.control();
+			h->capacity = static_cast<uint32_t>(capacity);
+			h->ready.store(segmentMagic, std::memory_order_release);
+			return shared;
+		}
+
+		/*!	@brief Open a segment made by @c create()
+		*/
+		static sharedSnapshot open(const std::string& name) {
+			sharedSnapshot shared;
+			if (shared.map(name, 0, false) && (shared.control()->ready.load(std::memory_order_acquire) != segmentMagic)) {
+				shared.close();
+			}
+			return shared;
+		}
+
+		bool is_open() const noexcept {
+			return m_view != nullptr;
+		}
+
+		/*!	@brief Write a snapshot of the parser's options as the next generation
+		* 
+		*	Not safe to call from more than one thread or process at a time.
+		* 
+		*	@return false, if the segment is not open or the snapshot is larger 
+		*	than its capacity
+		*/
+		template <typename Parser>
+		bool publish(const Parser& cmd) {
+			if (!is_open()) {
+				return false;
+			}
+
+			auto h = control();
+			const uint64_t next = h->generation.load(std::memory_order_relaxed) + 1;
+			const size_t size = cmd.write_snapshot(nullptr, 0);
+			if (size > h->capacity) {
+				return false;
+			}
+
+			// readers of the current generation use the other slot, but readers
+			// of the one before may still be in this one: mark it as being 
+			// written, and keep the writes of the snapshot after that mark
+			auto& sequence = h->sequence[next % 2];
+			const uint64_t start = sequence.load(std::memory_order_relaxed) + 1;
+			sequence.store(start, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+
+			cmd.write_snapshot(slot(next), size);
+
+			sequence.store(start + 1, std::memory_order_release);
+			h->generation.store(next, std::memory_order_release);
+			return true;
+		}
+
+		/*!	@brief Returns the generation last published, or 0 if there is none yet
+		*/
+		uint64_t get_generation() const noexcept {
+			return is_open() ? control()->generation.load(std::memory_order_acquire) : 0;
+		}
+
+		/*!	@brief Call @c fn with the current snapshot, and return its result
+		* 
+		*	@c fn may be called more than once, if a new generation is published
+		*	while it runs, so it must not have side effects, and must copy 
+		*	anything it returns out of the snapshot.
+		*/
+		template <typename Fn>
+		auto read(Fn&& fn) const -> decltype(fn(std::declval<const cmdSnapshot&>())) {
+			for (;;) {
+				const uint64_t generation = get_generation();
+				if (generation == 0) {
+					return fn(cmdSnapshot());
+				}
+
+				auto& sequence = control()->sequence[generation % 2];
+				const uint64_t start = sequence.load(std::memory_order_acquire);
+				if (start % 2 != 0) {
+					continue;
+				}
+
+				auto result = fn(cmdSnapshot(slot(generation), control()->capacity));
+				std::atomic_thread_fence(std::memory_order_acquire);
+				if (sequence.load(std::memory_order_relaxed) == start) {
+					return result;
+				}
+			}
+		}
+
+		bool has_param_option(std::string_view optionName) const {
+			return read([&](const cmdSnapshot& s) { return s.has_param_option(optionName); });
+		}
+
+		/*!	@brief Returns a copy of the option's value, as @c cmdSnapshot::get_value()
+		*/
+		std::string get_value(std::string_view optionName) const {
+			return read([&](const cmdSnapshot& s) { return std::string(s.get_value(optionName)); });
+		}
+
+		template <typename T>
+		convResult<T> try_get(std::string_view optionName) const {
+			static_assert(!std::is_same_v<T, std::string_view>, "views into the segment do not stay valid, use std::string");
+			return read([&](const cmdSnapshot& s) { return s.try_get<T>(optionName); });
+		}
+
+		int get_occurrence_count(std::string_view optionName) const {
+			return read([&](const cmdSnapshot& s) { return s.get_occurrence_count(optionName); });
+		}
+
+		/*!	@brief Returns a copy of the option's names, default value, value and kind, as @c basicCmdParse::get_param_option()
+		* 
+		*	A list option's converter is not in the snapshot, so it is not set.
+		*/
+		cmdOption get_param_option(std::string_view optionName) const {
+			return read([&](const cmdSnapshot& s) {
+				const int id = s.get_option_id(optionName);
+				if (id == cmdSnapshot::npos) {
+					return cmdOption{};
+				}
+
+				auto r = s.get_record(static_cast<uint32_t>(id));
+				cmdOption option{ std::string(s.text(r.longName)), std::string(s.text(r.defaultValue)), std::string(s.text(r.shortName)) };
+				option.paramValue = s.text(r.value);
+				option.kind = static_cast<optionKind>(r.kind);
+				return option;
+			});
+		}
+
+		void close() noexcept {
+			if (m_view == nullptr) {
+				return;
+			}
+
+#ifdef _WIN32
+			UnmapViewOfFile(m_view);
+			CloseHandle(m_mapping);
+			m_mapping = nullptr;
+#else
+			munmap(m_view, m_size);
+			if (m_owner) {
+				shm_unlink(m_name.c_str());
+			}
+#endif
+			m_view = nullptr;
+			m_size = 0;
+			m_owner = false;
+			m_name.clear();
+		}
+
+	private:
+		static constexpr uint32_t segmentMagic = 0x53444d53;	// "SMDS"
+		static constexpr size_t slotAlignment = 64;
+
+		struct controlBlock
+		{
+			std::atomic<uint32_t> ready;		// segmentMagic, once set up
+			uint32_t capacity;					// of each slot
+			std::atomic<uint64_t> generation;	// snapshot (generation % 2) is current
+			std::atomic<uint64_t> sequence[2];	// of each slot, odd while it is written
+		};
+
+		// the atomics are shared between processes, so they must not need a lock
+		static_assert(std::atomic<uint32_t>::is_always_lock_free && std::atomic<uint64_t>::is_always_lock_free,
+			"shared snapshots need lock-free atomics");
+		static constexpr size_t headerSize = (sizeof(controlBlock) + slotAlignment - 1) & ~(slotAlignment - 1);
+
+		void* m_view{ nullptr };
+		size_t m_size{ 0 };
+		bool m_owner{ false };
+		std::string m_name;
+#ifdef _WIN32
+		HANDLE m_mapping{ nullptr };
+#endif
+
+		controlBlock* control() const noexcept {
+			return static_cast<controlBlock*>(m_view);
+		}
+
+		unsigned char* slot(uint64_t generation) const noexcept {
+			return static_cast<unsigned char*>(m_view) + headerSize + (generation % 2) * control()->capacity;
+		}
+
+		void swap(sharedSnapshot& other) noexcept {
+			std::swap(m_view, other.m_view);
+			std::swap(m_size, other.m_size);
+			std::swap(m_owner, other.m_owner);
+			std::swap(m_name, other.m_name);
+#ifdef _WIN32
+			std::swap(m_mapping, other.m_mapping);
+#endif
+		}
+
+		// a new segment is zero filled, which is a valid (empty) control block
+		bool map(const std::string& name, size_t size, bool create) {
+#ifdef _WIN32
+			if (create) {
+				const uint64_t size64 = size;
+				m_mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+					static_cast<DWORD>(size64 >> 32), static_cast<DWORD>(size64), name.c_str());
+				if ((m_mapping != nullptr) && (GetLastError() == ERROR_ALREADY_EXISTS)) {
+					CloseHandle(m_mapping);
+					m_mapping = nullptr;
+				}
+			}
+			else {
+				m_mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, name.c_str());
+			}
+			if (m_mapping == nullptr) {
+				return false;
+			}
+
+			m_view = MapViewOfFile(m_mapping, create ? FILE_MAP_ALL_ACCESS : FILE_MAP_READ, 0, 0, 0);
+			if (m_view == nullptr) {
+				CloseHandle(m_mapping);
+				m_mapping = nullptr;
+				return false;
+			}
+
+			MEMORY_BASIC_INFORMATION info{};
+			VirtualQuery(m_view, &info, sizeof(info));
+			m_size = create ? size : info.RegionSize;
+#else
+			int fd = create ? shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600) : shm_open(name.c_str(), O_RDONLY, 0);
+			if (create && (fd < 0) && (errno == EEXIST)) {
+				// left behind by a creator that did not close it
+				shm_unlink(name.c_str());
+				fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+			}
+			if (fd < 0) {
+				return false;
+			}
+
+			struct stat info{};
+			if (create ? (ftruncate(fd, static_cast<off_t>(size)) != 0) : ((fstat(fd, &info) != 0) || (info.st_size < static_cast<off_t>(headerSize)))) {
+				::close(fd);
+				if (create) {
+					shm_unlink(name.c_str());
+				}
+				return false;
+			}
+
+			m_size = create ? size : static_cast<size_t>(info.st_size);
+			void* view = mmap(nullptr, m_size, create ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, fd, 0);
+			::close(fd);
+			if (view == MAP_FAILED) {
+				if (create) {
+					shm_unlink(name.c_str());
+				}
+				m_size = 0;
+				return false;
+			}
+			m_view = view;
+#endif
+			m_owner = create;
+			m_name = name;
+
+			// a segment too small for its own slots is not one of ours
+			if (!create && (m_size < headerSize + 2 * static_cast<uint64_t>(control()->capacity))) {
+				close();
+				return false;
+			}
+			return true;
+		}
+	};
+
+	/*!	@brief Case policies for @c basicCmdParse
+	* 
+	*	@c ignoreCase matches long option names regardless of case (the default),
+	*	@c matchCase requires an exact match and never lowercases anything.
+	*/
+	struct ignoreCase
+	{
+		static constexpr bool foldCase = true;
+
+		static int compare(std::string_view a, std::string_view b) noexcept {
+			return string_utils::icompare(a, b);
+		}
+
+		static bool equals(std::string_view a, std::string_view b) noexcept {
+			return string_utils::iequals(a, b);
+		}
+	};
+
+	struct matchCase
+	{
+		static constexpr bool foldCase = false;
+
+		static int compare(std::string_view a, std::string_view b) noexcept {
+			return a.compare(b);
+		}
+
+		static bool equals(std::string_view a, std::string_view b) noexcept {
+			return a == b;
+		}
+	};
+
+	/*!	@brief Syntax policy for @c basicCmdParse
+	* 
+	*	Lists the characters that separate an option name from its value, and
+	*	the quote character trimmed from values ('\0' for none).
+	* 
+	*   Example:
+	*	```cpp
+	*	// only accept --name=value, and leave quotes alone
+	*	using strictParse = basicCmdParse<matchCase, cmdSyntax<'\0', '='>>;
+	*	```
+	*/
+	template <char Quote, char... Separators>
+	struct cmdSyntax
+	{
+		static constexpr char quote = Quote;
+
+		static constexpr bool is_separator(char c) noexcept {
+			return ((c == Separators) || ...);
+		}
+	};
+
+	using defaultSyntax = cmdSyntax<'\"', ' ', ':', '='>;
+
+	/*!	@brief Error policies for @c basicCmdParse
+	* 
+	*	@c collectErrors keeps every error message (the default). With 
+	*	@c ignoreErrors no message is ever built; failures are still reported
+	*	through the return values.
+	*/
+	struct collectErrors
+	{
+		static constexpr bool enabled = true;
+	};
+
+	struct ignoreErrors
+	{
+		static constexpr bool enabled = false;
+	};
+
+
+	/*!	@brief Command-line options handler class
+	* 
+	*	The behaviour is chosen at compile time by the policies:
+	*	- @c CasePolicy : @c ignoreCase or @c matchCase for long option names
+	*	- @c SyntaxPolicy : separator and quote characters, see @c cmdSyntax
+	*	- @c ErrorPolicy : @c collectErrors or @c ignoreErrors
+	* 
+	*	Most applications will use the @c cmdParse alias, which has the defaults.
+	*/
+	template <typename CasePolicy = ignoreCase, typename SyntaxPolicy = defaultSyntax, typename ErrorPolicy = collectErrors>
+	class basicCmdParse
+	{
+	public:
+		basicCmdParse() = default;
+		
+		/*!	@brief Alternative constructor that takes preprepared options
+		* 
+		*   Example:
+		*	```cpp
+		*	cmdParse cmd( { {"optionA", "10", "a"}, {"backColour", "#FFFFFF", "b"} } );
+		*	cmd.init(argc, argv);
+		*	```
+		*/
+		basicCmdParse(std::vector<cmdOption> optionVec) {
+			add_param_options(std::move(optionVec));
+		}
+
+		/*!	@brief Initialize the command-line handler with the arguments given to the application
+		* 
+		*	Before calling, please add all the options that are to be supported by the application.
+		* 
+		*   Example:
+		*   ```cpp
+		*   int main(int argc, char *argv[])
+		*   {
+		*		cmdParse cmd;
+		* 
+		*		// Add supported options
+		*       cmd.add_param_option(cmdOption("BufferSize", "1000", 'b'));
+		*       cmd.add_param_option(cmdOption("OutputFile", "output.txt", 'o'));
+		* 
+		*		// Initialize with arguments
+		*       cmd.init(argc, argv);
+		*   }
+		*   ```
+		* 
+		*	Each call parses only the arguments it is given: the values of an
+		*	earlier call are cleared (its errors are kept, see @c clear_errors()).
+		*/
+		bool init(int argc, const char* argv[]) { 
+			if((argc <= 0) ) {
+				logError(errorCode::noArguments);
+				return false;
+			}
+
+			if (m_executable_name != argv[0]) {
+				m_executable_name = argv[0];
+				invalidateHelp();
+			}
+
+			// argv indices are taken from positions in m_arguments, so it must 
+			// only hold this argv
+			clearValues();
+			m_argv = argv;
+			m_argc = argc;
+
+			m_arg_starts.assign(1, 0);
+			for(int n = 1; n < argc; n++) {
+				
+				std::string arg_str = argv[n];
+				m_arg_starts.push_back(m_argv_text);
+				m_argv_text += static_cast<uint32_t>(arg_str.size());
+				WGT::string_utils::trim(arg_str);
+				m_arguments.push_back(arg_str);
+			}
+
+			// the first argument that is not an option names the subcommand,
+			// which parses the rest of the command-line
+			basicCmdParse* subcommandParser = nullptr;
+			int subcommandArg = 0;
+			m_active_subcommand = npos;
+			if (!m_subcommands.empty()) {
+				auto last = std::find(m_arguments.begin(), m_arguments.end(), "--");
+				auto it = std::find_if(m_arguments.begin(), last, [](const std::string& s) {
+					return !s.empty() && (s[0] != '-') && !SyntaxPolicy::is_separator(s[0]);
+				});
+
+				if (it != last) {
+					subcommandArg = static_cast<int>(it - m_arguments.begin()) + 1;
+					subcommandParser = selectSubcommand(*it);
+					if (subcommandParser == nullptr) {
+						m_error_arg_index = subcommandArg;
+						logError(errorCode::subcommandNotFound, *it);
+						m_error_arg_index = -1;
+						return false;
+					}
+					m_arguments.erase(it, m_arguments.end());
+				}
+			}
+
+			auto result = parseOptions();
+			m_error_arg_index = -1;
+
+			if (subcommandParser != nullptr) {
+				result = subcommandParser->init(argc - subcommandArg, argv + subcommandArg) && result;
+			}
+			return result;
+		}
+
+		/*!	@brief Initialize the command-line handler with a whole command-line
+		* 
+		*	For command-lines that arrive as one string, e.g. from a job queue
+		*	or GetCommandLine(). The first argument is the executable name, as
+		*	in argv[0]. The string is copied once and split in place (see 
+		*	@c cmdLineTokenizer), and the views returned by the parser (e.g. 
+		*	@c get_positionals()) point into that copy, which is kept until the
+		*	next call.
+		* 
+		*   Example:
+		*	```cpp
+		*	cmd.init_from_string(R"(MyApp.exe --Title="Hello World" "C:\My Files\in.txt")");
+		*	```
+		*/
+		bool init_from_string(std::string_view commandLine, quoteRules rules = quoteRules::windows) {
+			m_command_line.assign(commandLine.data(), commandLine.size());
+			cmdLineTokenizer::split(m_command_line, rules, m_command_argv);
+			return init(static_cast<int>(m_command_argv.size()) - 1, m_command_argv.data());
+		}
+
+		/*!	@brief Apply a few options on top of the parsed command-line, e.g. "--BufferSize=64"
+		* 
+		*	For interactive tools, to change some options without parsing the 
+		*	whole command-line again. Only the delta is split (as by 
+		*	init_from_string()) and parsed; the slots of the options it names 
+		*	are updated in place, and nothing else is touched. An overridden 
+		*	option is as if only given in the delta: its value is replaced 
+		*	whatever its repeat policy, and its count starts again. A map 
+		*	option's keys are merged, the given keys replacing their values.
+		* 
+		*	The delta may only hold options. If an option is in error, the ones
+		*	before it are still applied.
+		* 
+		*   Example:
+		*	```cpp
+		*	std::vector<int> changed;
+		*	cmd.override_options("--BufferSize=64 -v", changed);
+		*	```
+		* 
+		*	@param changedIds receives the ids of the options whose value or count
+		*	changed (map and accumulated options are always included, if given)
+		*/
+		bool override_options(std::string_view delta, std::vector<int>& changedIds, quoteRules rules = quoteRules::windows) {
+			m_override_text.assign(delta.data(), delta.size());
+			cmdLineTokenizer::split(m_override_text, rules, m_override_argv, false);
+			return override_options(static_cast<int>(m_override_argv.size()) - 1, m_override_argv.data(), changedIds);
+		}
+
+		/*!	@brief Apply a few options on top of the parsed command-line, given as an argv array with no program name
+		*/
+		bool override_options(int argc, const char* const argv[], std::vector<int>& changedIds) {
+			changedIds.clear();
+			if (m_occurrence_counts.size() < m_options.size()) {
+				m_occurrence_counts.resize(m_options.size(), 0);
+				m_given.resize(m_options.size(), 0);
+				m_occurrence_lists.resize(m_options.size());
+			}
+
+			std::vector<uint32_t> overridden;
+			m_override_before.clear();
+
+			// trimmed as init() trims the arguments
+			auto trimmed = [](std::string_view arg) {
+				const auto first = arg.find_first_not_of(' ');
+				return (first == std::string_view::npos) ? std::string_view{} : arg.substr(first, arg.find_last_not_of(' ') - first + 1);
+			};
+
+			bool result = true;
+			std::string fullOptionString;
+			for (int n = 0; n < argc; ) {
+				std::string_view arg = trimmed(argv[n]);
+				if ((arg.size() < 2) || (arg[0] != '-') || (arg == "--")) {
+					logError(errorCode::unexpectedArgument, arg);
+					result = false;
+					break;
+				}
+
+				// the option, and any arguments that continue its value
+				fullOptionString.assign(arg);
+				for (n++; (n < argc); n++) {
+					std::string_view next = trimmed(argv[n]);
+					if (next.empty() || !SyntaxPolicy::is_separator(next[0])) {
+						break;
+					}
+					fullOptionString += next;
+				}
+
+				if (applySection(fullOptionString, 0, false, &overridden) != sectionResult::done) {
+					result = false;
+					break;
+				}
+			}
+
+			compactText();
+
+			for (size_t n = 0; n < overridden.size(); n++) {
+				const auto id = overridden[n];
+				const auto option = m_options[id];
+				const auto& before = m_override_before[n];
+				if (option.is_map() || (option.repeat == repeatPolicy::accumulate)
+					|| (before.count != m_occurrence_counts[id]) || (before.value != option.paramValue)) {
+					changedIds.push_back(static_cast<int>(id));
+				}
+			}
+			return result;
+		}
+
+		/*!	@brief Clears the arguments, parsed values and errors
+		* 
+		*	The registered options are kept, so the same handler can be used 
+		*	to parse another command-line with @c init().
+		*/
+		void reset() {
+			m_executable_name.clear();
+			invalidateHelp();
+			clear_errors();
+			clearValues();
+			m_occurrence_counts.clear();
+			m_given.clear();
+			m_occurrence_lists.clear();
+			m_argv = nullptr;
+			m_argc = 0;
+			m_positionals.clear();
+			m_passthrough = {};
+			m_unknown_options.clear();
+			m_forward_args.clear();
+
+			if (auto subcommandParser = get_subcommand()) {
+				subcommandParser->reset();
+			}
+			m_active_subcommand = npos;
+		}
+
+		/*!	@brief Add a subcommand, as in "app [options] <subcommand> [subcommand options]"
+		* 
+		*	The subcommand has its own options, in a parser of its own. @c setup 
+		*	adds them, and is only called when the subcommand is first used; so
+		*	an application with many subcommands only pays for the one that is 
+		*	on its command-line. The first argument that is not an option names
+		*	the subcommand, and is found with a single hash lookup.
+		* 
+		*   Example:
+		*	```cpp
+		*	cmd.add_subcommand("clone", [](cmdParse& sub) {
+		*		sub.emplace_option("depth", "0", "d");
+		*	});
+		*	cmd.init(argc, argv);
+		*	if (cmd.get_subcommand_name() == "clone") {
+		*		auto depth = cmd.get_subcommand()->try_get<int>("depth");
+		*	}
+		*	```
+		* 
+		*	@return false, if a subcommand with the same name was already added
+		*/
+		bool add_subcommand(std::string_view name, std::function<void(basicCmdParse&)> setup) {
+			const auto key = subcommandKey(name);
+			if (m_subcommand_index.find(m_subcommand_names, 0, key) != nullptr) {
+				logError(errorCode::subcommandExists, name);
+				return false;
+			}
+
+			// the value of each index entry is the subcommand number
+			flatStringMap::entry e;
+			e.keyOffset = static_cast<uint32_t>(m_subcommand_names.size());
+			e.keyLength = static_cast<uint32_t>(key.size());
+			e.valueOffset = static_cast<uint32_t>(m_subcommands.size());
+			m_subcommand_names += key;
+			m_subcommand_index.insert(m_subcommand_names, e);
+
+			m_subcommands.push_back({ std::string(name), std::move(setup) });
+			return true;
+		}
+
+		/*!	@brief Returns the name of the subcommand on the command-line, or an empty string
+		*/
+		std::string_view get_subcommand_name() const noexcept {
+			return (m_active_subcommand == npos) ? std::string_view{} : std::string_view(m_subcommands[m_active_subcommand].name);
+		}
+
+		/*!	@brief Returns the parser of the subcommand on the command-line, or nullptr
+		* 
+		*	It holds the subcommand's options, values and errors. The pointer is
+		*	valid until the next call to @c init().
+		*/
+		basicCmdParse* get_subcommand() noexcept {
+			return (m_active_subcommand == npos) ? nullptr : &m_subcommand_parsers[m_subcommands[m_active_subcommand].parser];
+		}
+
+		const basicCmdParse* get_subcommand() const noexcept {
+			return (m_active_subcommand == npos) ? nullptr : &m_subcommand_parsers[m_subcommands[m_active_subcommand].parser];
+		}
+
+		/*!	@brief Returns the arguments that are not options, in order
+		* 
+		*	These are views of the strings in the argv given to @c init(), so they
+		*	are valid for as long as argv is. Arguments after "--" are not 
+		*	included, see @c get_passthrough().
+		*/
+		const std::vector<std::string_view>& get_positionals() const noexcept {
+			return m_positionals;
+		}
+
+		/*!	@brief Returns the arguments after "--", which are not parsed
+		* 
+		*	The view points into the argv given to @c init(); nothing is copied.
+		*	For the argv of main(), argv[argc] is a null pointer, so @c data is a 
+		*	null-terminated array that can be passed straight to execv:
+		*	```cpp
+		*	auto child = cmd.get_passthrough();
+		*	if (!child.empty()) {
+		*		execv(child[0], const_cast<char* const*>(child.data));
+		*	}
+		*	```
+		* 
+		*	@return a view with a null @c data if there was no "--"
+		*/
+		listView<const char*> get_passthrough() const noexcept {
+			return m_passthrough;
+		}
+
+		/*!	@brief Keep parsing when an option is not recognised, and collect it instead
+		* 
+		*	For wrappers, that take their own options and pass the rest on to
+		*	another program. Unknown options are then not errors; they are kept 
+		*	in order, see @c get_unknown_options() and @c get_forward_argv().
+		*/
+		void set_unknown_passthrough(bool enabled = true) noexcept {
+			m_pass_unknown = enabled;
+		}
+
+		/*!	@brief Returns the unrecognised arguments, when @c set_unknown_passthrough() is on
+		* 
+		*	Like the positional arguments, these are views into argv. An unknown
+		*	option whose value was in the following argument (e.g. "=1234") 
+		*	contributes both arguments.
+		*/
+		const std::vector<std::string_view>& get_unknown_options() const noexcept {
+			return m_unknown_options;
+		}
+
+		/*!	@brief Returns the arguments that were not used, as an argv for another program
+		* 
+		*	The array has @c program (if given), then the unknown options and the 
+		*	positional arguments in their original order, then the arguments after
+		*	"--", and a null pointer at the end. It is built in one allocation, 
+		*	and points to the strings in the original argv.
+		* 
+		*   Example:
+		*	```cpp
+		*	cmd.set_unknown_passthrough();
+		*	cmd.init(argc, argv);
+		*	auto args = cmd.get_forward_argv("/usr/bin/child");
+		*	execv(args[0], const_cast<char* const*>(args.data()));
+		*	```
+		*/
+		std::vector<const char*> get_forward_argv(const char* program = nullptr) const {
+			std::vector<const char*> args;
+			args.reserve(((program != nullptr) ? 1 : 0) + m_forward_args.size() + m_passthrough.size + 1);
+
+			if (program != nullptr) {
+				args.push_back(program);
+			}
+			for (auto n : m_forward_args) {
+				args.push_back(m_argv[n]);
+			}
+			args.insert(args.end(), m_passthrough.begin(), m_passthrough.end());
+			args.push_back(nullptr);
+			return args;
+		}
+
+		/*!	@brief Write the options and their values as a binary snapshot, into the caller's buffer
+		* 
+		*	The snapshot can be shared with other processes (e.g. through a file
+		*	or shared memory), which query it in place with @c cmdSnapshot. It 
+		*	holds every option's names, default value, value and count, and the
+		*	positional arguments; the other parse results (lists, maps and 
+		*	accumulated values) are only there as their raw text, if at all.
+		*	The subcommand on the command-line, if any, is written as a snapshot
+		*	of its own, nested in this one (see cmdSnapshot::get_subcommand()).
+		* 
+		*   Example:
+		*	```cpp
+		*	std::vector<unsigned char> blob(cmd.write_snapshot(nullptr, 0));
+		*	cmd.write_snapshot(blob.data(), blob.size());
+		*	```
+		* 
+		*	@return the number of bytes needed. If @c size is less than that, 
+		*	nothing is written.
+		*/
+		size_t write_snapshot(void* buffer, size_t size) const {
+			using snapshot = cmdSnapshot;
+
+			stringPool pool;
+			const auto optionCount = static_cast<uint32_t>(m_options.size());
+			std::vector<snapshot::record> records(optionCount);
+			for (uint32_t id = 0; id < optionCount; id++) {
+				const auto o = m_options[id];
+				auto& r = records[id];
+				r.longName = pool.intern(o.longName);
+				r.shortName = pool.intern(o.shortName);
+				r.defaultValue = pool.intern(o.defaultValue);
+				r.value = pool.intern(o.paramValue);
+				r.kind = static_cast<uint8_t>(o.kind);
+				r.count = (id < m_occurrence_counts.size()) ? m_occurrence_counts[id] : 0;
+				r.reserved[0] = r.reserved[1] = r.reserved[2] = 0;
+			}
+
+			std::vector<stringPool::ref> positionals;
+			positionals.reserve(m_positionals.size());
+			for (auto positional : m_positionals) {
+				positionals.push_back(pool.intern(positional));
+			}
+
+			// open addressing, at most half full
+			uint32_t slotCount = 2;
+			while (slotCount < optionCount * 2) {
+				slotCount *= 2;
+			}
+
+			std::vector<uint32_t> longSlots(slotCount, 0);
+			std::vector<uint32_t> shortSlots(slotCount, 0);
+			auto insert = [&](std::vector<uint32_t>& slots, std::string_view key, bool ignoreCase, bool shortName, uint32_t id) {
+				const uint32_t mask = slotCount - 1;
+				for (auto n = static_cast<uint32_t>(hash_utils::hash(key, 0, ignoreCase)) & mask; ; n = (n + 1) & mask) {
+					if (slots[n] == 0) {
+						slots[n] = id + 1;
+						return;
+					}
+
+					// the first option with a short name keeps it, as in freeze()
+					if (shortName && (m_options.short_name(slots[n] - 1) == key)) {
+						return;
+					}
+				}
+			};
+			for (uint32_t id = 0; id < optionCount; id++) {
+				insert(longSlots, m_options.long_name(id), CasePolicy::foldCase, false, id);
+				insert(shortSlots, m_options.short_name(id), false, true, id);
+			}
+
+			const auto subcommandParser = get_subcommand();
+			const auto subcommandName = pool.intern(get_subcommand_name());
+
+			snapshot::header h{};
+			h.magic = snapshot::magic;
+			h.version = snapshot::version;
+			h.flags = CasePolicy::foldCase ? snapshot::ignoreCaseFlag : 0;
+			h.optionCount = optionCount;
+			h.slotCount = slotCount;
+			h.positionalCount = static_cast<uint32_t>(positionals.size());
+			h.recordsOffset = sizeof(snapshot::header);
+			h.longSlotsOffset = h.recordsOffset + optionCount * static_cast<uint32_t>(sizeof(snapshot::record));
+			h.shortSlotsOffset = h.longSlotsOffset + slotCount * static_cast<uint32_t>(sizeof(uint32_t));
+			h.positionalsOffset = h.shortSlotsOffset + slotCount * static_cast<uint32_t>(sizeof(uint32_t));
+			h.textOffset = h.positionalsOffset + h.positionalCount * static_cast<uint32_t>(sizeof(stringPool::ref));
+			h.textSize = static_cast<uint32_t>(pool.size());
+			h.subcommandName = subcommandName;
+
+			uint64_t total = static_cast<uint64_t>(h.textOffset) + h.textSize;
+			if (subcommandParser != nullptr) {
+				// the nested snapshot must be 4-byte aligned as well
+				total = (total + 3) & ~uint64_t(3);
+				h.subcommandOffset = static_cast<uint32_t>(total);
+				h.subcommandSize = static_cast<uint32_t>(subcommandParser->write_snapshot(nullptr, 0));
+				total += h.subcommandSize;
+			}
+			assert(total <= (std::numeric_limits<uint32_t>::max)());
+			h.size = static_cast<uint32_t>(total);
+
+			if ((buffer == nullptr) || (size < total)) {
+				return static_cast<size_t>(total);
+			}
+
+			auto out = static_cast<unsigned char*>(buffer);
+			std::memcpy(out, &h, sizeof(h));
+			std::memcpy(out + h.recordsOffset, records.data(), records.size() * sizeof(snapshot::record));
+			std::memcpy(out + h.longSlotsOffset, longSlots.data(), longSlots.size() * sizeof(uint32_t));
+			std::memcpy(out + h.shortSlotsOffset, shortSlots.data(), shortSlots.size() * sizeof(uint32_t));
+			if (!positionals.empty()) {
+				std::memcpy(out + h.positionalsOffset, positionals.data(), positionals.size() * sizeof(stringPool::ref));
+			}
+			if (h.textSize != 0) {
+				std::memcpy(out + h.textOffset, pool.data().data(), h.textSize);
+			}
+			if (subcommandParser != nullptr) {
+				const size_t textEnd = static_cast<size_t>(h.textOffset) + h.textSize;
+				std::memset(out + textEnd, 0, h.subcommandOffset - textEnd);
+				subcommandParser->write_snapshot(out + h.subcommandOffset, h.subcommandSize);
+			}
+			return static_cast<size_t>(total);
+		}
+
+		/*!	@brief Write the current option values as an argv array, into the caller's buffer
+		* 
+		*	The array of pointers and the strings it points to are all written to
+		*	@c buffer, so nothing is allocated. The arguments are, in order:
+		*	@c program (or the executable name given to init()), the options 
+		*	that were given (all options, with @c style.allOptions) in order of
+		*	registration, the positional arguments, then "--" and the arguments
+		*	after it. A subcommand follows the application's options, with its
+		*	own arguments in the same order. A value is quoted if the parser 
+		*	would otherwise trim it.
+		* 
+		*	The parser strips quotes from both ends of a value, and there is no
+		*	escape for them, so a value that begins or ends with a quote cannot 
+		*	be written. Its option is returned in @c unreadable, and nothing is 
+		*	written.
+		* 
+		*	With @c style.quoteSpaces, each argument that has blanks or quotes 
+		*	is quoted and escaped by @c quoteRules::windows, so that the 
+		*	arguments joined with spaces split into the same argv again (e.g. by
+		*	@c init_from_string() or the child's C runtime).
+		* 
+		*   Example:
+		*	```cpp
+		*	auto needed = cmd.write_argv(nullptr, 0).size;
+		*	std::vector<char> buffer(needed);
+		*	auto args = cmd.write_argv(buffer.data(), buffer.size());
+		*	execv(args.argv[0], const_cast<char* const*>(args.argv));
+		*	```
+		* 
+		*	@return the array, and the number of bytes needed. If @c size is less
+		*	than that, nothing is written and the array is nullptr.
+		*/
+		argvBuffer write_argv(void* buffer, size_t size, const argvStyle& style = {}, const char* program = nullptr) const {
+			argvBuffer result;
+			size_t textSize = 0;
+			forEachArgument(style, program, result.unreadable, [&](std::initializer_list<std::string_view> parts) {
+				// the program has no escapes, see cmdLineTokenizer
+				textSize += joinArgument(nullptr, parts, style.quoteSpaces, result.argc != 0) + 1;
+				result.argc++;
+			});
+
+			const size_t arraySize = (static_cast<size_t>(result.argc) + 1) * sizeof(const char*);
+			result.size = (alignof(const char*) - 1) + arraySize + textSize;
+
+			void* aligned = buffer;
+			size_t space = size;
+			if ((buffer == nullptr) || (size < result.size) || !result.unreadable.empty() || (std::align(alignof(const char*), arraySize, aligned, space) == nullptr)) {
+				return result;
+			}
+
+			auto args = static_cast<const char**>(aligned);
+			char* text = reinterpret_cast<char*>(args + result.argc + 1);
+			size_t n = 0;
+			std::string_view unreadable;
+			forEachArgument(style, program, unreadable, [&](std::initializer_list<std::string_view> parts) {
+				args[n] = text;
+				text += joinArgument(text, parts, style.quoteSpaces, n != 0);
+				*text++ = '\0';
+				n++;
+			});
+			args[n] = nullptr;
+
+			result.argv = args;
+			return result;
+		}
+
+		/*!	@brief Returns the list of arguments that was supplied to the application
+		* 
+		*   This does not include the name of the client executable, nor a
+		*	subcommand and its arguments.
+		*/
+		std::vector<std::string> get_arguments() noexcept {
+			return m_arguments;
+		}
+
+		/*!	@brief Add a command-line option that the application will support
+		* 
+		*	@return false, if unable to set option. This could be due to 
+		*   conflict in the option name provided. Check any reported errors if false.
+		* 
+		*	@sa get_errors
+		*/
+		bool add_param_option(const cmdOption& paramOption) {
+			return emplaceOption(paramOption.longName, [&]() { return paramOption; });
+		}
+
+		bool add_param_option(cmdOption&& paramOption) {
+			return emplaceOption(paramOption.longName, [&]() { return std::move(paramOption); });
+		}
+
+		/*!	@brief Construct a command-line option in place
+		* 
+		*	Same as @c add_param_option(), but the option strings are allocated
+		*	once, directly in the handler's storage, and not at all if the name
+		*	is already taken.
+		* 
+		*   Example:
+		*	```cpp
+		*	cmd.emplace_option("BufferSize", "1000", "b");
+		*	```
+		*/
+		bool emplace_option(std::string_view optionName, std::string_view defaultValue = "", std::string_view optionNameShort = "") {
+			return emplaceOption(optionName, [&]() {
+				return cmdOption(std::string(optionName), std::string(defaultValue), std::string(optionNameShort));
+			});
+		}
+
+		/*!	@brief Add a batch of command-line options in one pass
+		* 
+		*	The options are sorted once and merged into the lookup index, rather
+		*	than inserted one at a time. Options whose name is already taken (by a
+		*	previously added option, or earlier in the batch) are dropped and each
+		*	one is reported as an error.
+		* 
+		*	@return the number of options that were added
+		* 
+		*	@sa add_param_option
+		*/
+		int add_param_options(std::vector<cmdOption> optionVec) {
+
+			if (m_frozen) {
+				for (auto& o : optionVec) {
+					logError(errorCode::optionsFrozen, o.longName);
+				}
+				return 0;
+			}
+
+			const auto existingCount = m_options.size();
+
+			// sort the new options by name; stable, so of any equal names the earliest added comes first
+			std::vector<uint32_t> order(optionVec.size());
+			std::iota(order.begin(), order.end(), 0);
+			std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+				return CasePolicy::compare(optionVec[a].longName, optionVec[b].longName) < 0;
+			});
+
+			// an option is a duplicate if its predecessor in the batch, or an existing option, has its name
+			std::vector<bool> duplicate(optionVec.size(), false);
+			size_t textBytes = 0;
+			for (size_t n = 0; n < order.size(); n++) {
+				auto& o = optionVec[order[n]];
+				if (((n > 0) && CasePolicy::equals(optionVec[order[n - 1]].longName, o.longName)) || (findOption(o.longName) != npos)) {
+					duplicate[order[n]] = true;
+					logError(errorCode::optionExists, o.longName);
+				}
+				textBytes += o.longName.size() + o.shortName.size() + o.defaultValue.size();
+			}
+
+			// add them in the order given
+			std::vector<uint32_t> ids(optionVec.size());
+			m_options.reserve(existingCount + optionVec.size(), textBytes);
+			for (size_t n = 0; n < optionVec.size(); n++) {
+				if (!duplicate[n]) {
+					ids[n] = m_options.add(optionVec[n]);
+					if (optionVec[n].is_list()) {
+						addList(ids[n], optionVec[n]);
+					}
+					if (optionVec[n].is_map()) {
+						m_map_short_length = (std::max)(m_map_short_length, static_cast<uint32_t>(optionVec[n].shortName.size()));
+					}
+				}
+			}
+
+			// the new ids are already in order of name, so only a merge with the existing ids is left
+			m_option_index.reserve(m_options.size());
+			for (auto n : order) {
+				if (!duplicate[n]) {
+					m_option_index.push_back(ids[n]);
+				}
+			}
+			std::inplace_merge(m_option_index.begin(), m_option_index.begin() + existingCount, m_option_index.end(), [this](uint32_t a, uint32_t b) {
+				return CasePolicy::compare(m_options.long_name(a), m_options.long_name(b)) < 0;
+			});
+
+			invalidateHelp();
+			return static_cast<int>(m_options.size() - existingCount);
+		}
+
+		/*!	@brief Returns the value of an option, converted to @c T, without throwing
+		* 
+		*	The value given on the command-line is used, or the option's default
+		*	value if it was not given.
+		* 
+		*	@sa convertValue
+		*/
+		template <typename T>
+		convResult<T> try_get(std::string_view optionName) const {
+			auto id = findOption(optionName);
+			if (id == npos) {
+				return convError::unknownOption;
+			}
+
+			return convertValue<T>(get_value(id));
+		}
+
+		/*!	@brief Returns the value given on the command-line, or the default value if it was not given
+		* 
+		*	@param id from @c get_option_id()
+		*/
+		std::string_view get_value(int id) const noexcept {
+			assert((id >= 0) && (static_cast<size_t>(id) < m_options.size()));
+			const auto option = m_options[id];
+			const bool given = (static_cast<size_t>(id) < m_given.size()) && (m_given[id] != 0);
+			return given ? std::string_view(option.paramValue) : std::string_view(option.defaultValue);
+		}
+
+		std::string_view get_value(std::string_view optionName) const {
+			auto id = findOption(optionName);
+			return (id == npos) ? std::string_view{} : get_value(id);
+		}
+
+		/*!	@brief Add an option that holds a delimited list of numbers (or any
+		*	other trivially copyable type with an @c option_traits converter)
+		* 
+		*	The value is split and converted to @c T once, when the arguments are 
+		*	parsed, into a single contiguous array. An element that cannot be 
+		*	converted is reported as an error, with its position in the value.
+		* 
+		*   Example:
+		*	```cpp
+		*	cmd.add_list_option<double>("weights", "1,1,1", "w");
+		*	...
+		*	for (double w : cmd.get_list<double>("weights")) { ... }
+		*	```
+		*/
+		template <typename T>
+		bool add_list_option(std::string_view optionName, std::string_view defaultValue = "", std::string_view optionNameShort = "", char delimiter = ',') {
+			return emplaceOption(optionName, [&]() {
+				cmdOption option{ std::string(optionName), std::string(defaultValue), std::string(optionNameShort) };
+				option.kind = optionKind::list;
+				option.listConvert = &convertListElements<T>;
+				option.listType = typeid(T);
+				option.listDelimiter = delimiter;
+				return option;
+			});
+		}
+
+		/*!	@brief Returns the converted elements of a list option
+		* 
+		*	If the option was not given, the elements of its default value are 
+		*	returned. The view is valid until the next parse or @c reset().
+		* 
+		*	@return an empty view, if there is no such list option of type @c T
+		*/
+		template <typename T>
+		listView<T> get_list(std::string_view optionName) const {
+			auto id = findOption(optionName);
+			auto list = (id == npos) ? nullptr : findList(static_cast<uint32_t>(id));
+			if ((list == nullptr) || (list->type != typeid(T))) {
+				return {};
+			}
+
+			auto& elements = list->parsed ? list->values : list->defaults;
+			return { reinterpret_cast<const T*>(elements.data()), elements.size() / sizeof(T) };
+		}
+
+		/*!	@brief Add an option that collects key/value pairs
+		* 
+		*	Every occurrence adds an entry, in any of these forms:
+		*	```
+		*	> myapp.exe -DNAME=value -D:OTHER=value --define=LAST:value
+		*	```
+		*	The key and value are split on the same separators as an option 
+		*	name and its value. A key given twice keeps the last value.
+		* 
+		*   Example:
+		*	```cpp
+		*	cmd.add_map_option("define", "D");
+		*	...
+		*	auto value = cmd.get_map_value("define", "NAME");
+		*	```
+		*/
+		bool add_map_option(std::string_view optionName, std::string_view optionNameShort = "") {
+			return emplaceOption(optionName, [&]() {
+				cmdOption option{ std::string(optionName), "", std::string(optionNameShort) };
+				option.kind = optionKind::map;
+				return option;
+			});
+		}
+
+		/*!	@brief Returns the value stored for the key, in a map option
+		* 
+		*	The view is valid until the next parse or @c reset().
+		*/
+		std::optional<std::string_view> get_map_value(std::string_view optionName, std::string_view key) const {
+			auto id = findOption(optionName);
+			if (id == npos) {
+				return std::nullopt;
+			}
+
+			auto e = m_map_entries.find(textFn(), static_cast<uint32_t>(id), key);
+			if (e == nullptr) {
+				return std::nullopt;
+			}
+
+			return textView(e->valueOffset, e->valueLength);
+		}
+
+		/*!	@brief Returns every key/value pair of a map option, in no particular order
+		*/
+		std::vector<std::pair<std::string_view, std::string_view>> get_map_entries(std::string_view optionName) const {
+			std::vector<std::pair<std::string_view, std::string_view>> entries;
+			auto id = findOption(optionName);
+			if (id != npos) {
+				m_map_entries.for_each(static_cast<uint32_t>(id), [&](const flatStringMap::entry& e) {
+					entries.emplace_back(textView(e.keyOffset, e.keyLength), textView(e.valueOffset, e.valueLength));
+				});
+			}
+			return entries;
+		}
+
+		/*!	@brief Add an option that takes no value, such as --verbose or -v
+		* 
+		*	Short flags can be combined, and repeated to count them:
+		*	```
+		*	> myapp.exe -xvf -vvv --verbose
+		*	```
+		*	A flag may also be given an explicit boolean value, e.g. --verbose=no.
+		* 
+		*	@sa is_flag_set, get_flag_count
+		*/
+		bool add_flag_option(std::string_view optionName, std::string_view optionNameShort = "") {
+			return emplaceOption(optionName, [&]() {
+				cmdOption option{ std::string(optionName), "", std::string(optionNameShort) };
+				option.kind = optionKind::flag;
+				return option;
+			});
+		}
+
+		/*!	@brief Returns the id of an option, for the id-based accessors
+		* 
+		*	Ids do not change once an option is added.
+		* 
+		*	@return -1 if not found
+		*/
+		int get_option_id(std::string_view optionName) const {
+			return findOption(optionName);
+		}
+
+		/*!	@brief Test if a flag was given on the command-line
+		* 
+		*	@param id from @c get_option_id()
+		*/
+		bool is_flag_set(int id) const noexcept {
+			assert((id >= 0) && (static_cast<size_t>(id) < m_options.size()));
+			return (static_cast<size_t>(id) < m_given.size()) && (m_given[id] != 0);
+		}
+
+		bool is_flag_set(std::string_view optionName) const {
+			auto id = findOption(optionName);
+			return (id != npos) && is_flag_set(id);
+		}
+
+		/*!	@brief Returns the number of times a flag was given, e.g. 3 for -vvv
+		*/
+		int get_flag_count(std::string_view optionName) const {
+			return get_occurrence_count(optionName);
+		}
+
+		/*!	@brief Set what happens when the option is given more than once
+		* 
+		*   Example:
+		*	```cpp
+		*	cmd.emplace_option("include", "", "I");
+		*	cmd.set_repeat_policy("include", repeatPolicy::accumulate);
+		*	```
+		* 
+		*	@return false, if the option does not exist
+		*/
+		bool set_repeat_policy(std::string_view optionName, repeatPolicy policy) {
+			auto id = findOption(optionName);
+			if (id == npos) {
+				return false;
+			}
+
+			m_options.set_repeat(static_cast<uint32_t>(id), policy);
+			return true;
+		}
+
+		/*!	@brief Returns the number of times the option was given on the command-line
+		*/
+		int get_occurrence_count(std::string_view optionName) const {
+			auto id = findOption(optionName);
+			if ((id == npos) || (static_cast<size_t>(id) >= m_occurrence_counts.size())) {
+				return 0;
+			}
+
+			return clampCount(m_occurrence_counts[id]);
+		}
+
+		/*!	@brief Returns every value given for an option with @c repeatPolicy::accumulate
+		* 
+		*	The values are in command-line order. The views are valid until the next
+		*	parse or @c reset().
+		*/
+		std::vector<std::string_view> get_values(std::string_view optionName) const {
+			std::vector<std::string_view> values;
+			auto id = findOption(optionName);
+			if ((id == npos) || (static_cast<size_t>(id) >= m_occurrence_counts.size())) {
+				return values;
+			}
+
+			values.reserve(m_occurrence_counts[id]);
+			forEachOccurrence(static_cast<uint32_t>(id), [&](const occurrence& o) {
+				values.push_back(textView(o.offset, o.length));
+			});
+			return values;
+		}
+
+		/*!	@brief Fix the set of options, and build fast lookup tables for them
+		* 
+		*	Call once all the options have been added. A minimal perfect hash is 
+		*	built over the (case-insensitive) long names and the short names, so
+		*	each lookup is one hash and one compare. Any further attempt to add
+		*	an option is rejected, and reported as an error.
+		* 
+		*	@return false, if the short names are not unique. The options are 
+		*	still frozen; a short name resolves to the first option that uses it.
+		*/
+		bool freeze() {
+			if (m_frozen) {
+				return true;
+			}
+
+			std::vector<std::string_view> keys;
+			keys.reserve(m_options.size());
+			for (uint32_t id = 0; id < m_options.size(); id++) {
+				keys.push_back(m_options.long_name(id));
+			}
+
+			// long names are unique, so this can only fail on the unlikely event of running out of seeds
+			if (!m_long_hash.build(keys, CasePolicy::foldCase, m_long_slots)) {
+				logError(errorCode::lookupTableFailed);
+				return false;
+			}
+
+			// short names are matched exactly, keep the first use of each
+			std::vector<uint32_t> shortIds(m_options.size());
+			std::iota(shortIds.begin(), shortIds.end(), 0);
+			std::stable_sort(shortIds.begin(), shortIds.end(), [this](uint32_t a, uint32_t b) {
+				return m_options.short_name(a) < m_options.short_name(b);
+			});
+
+			bool uniqueShortNames = true;
+			std::vector<uint32_t> keyIds;
+			keys.clear();
+			for (auto id : shortIds) {
+				std::string_view shortName = m_options.short_name(id);
+				if (!keys.empty() && (keys.back() == shortName)) {
+					logError(errorCode::shortNameReused, m_options.short_name(id), static_cast<int>(id));
+					uniqueShortNames = false;
+					continue;
+				}
+				keys.push_back(shortName);
+				keyIds.push_back(id);
+			}
+
+			if (!m_short_hash.build(keys, false, m_short_slots)) {
+				logError(errorCode::lookupTableFailed);
+				return false;
+			}
+			for (auto& slot : m_short_slots) {
+				slot = keyIds[slot];
+			}
+
+			m_frozen = true;
+			return uniqueShortNames;
+		}
+
+		/*!	@brief Test if @c freeze() has been called
+		*/
+		bool is_frozen() const noexcept {
+			return m_frozen;
+		}
+
+		/*!	@brief Returns the number of command-line options that have been added
+		* 
+		*	Use @c add_param_option() to add more options to the handler.
+		* 
+		*	@sa add_param_option
+		*	@sa has_param_option
+		*/
+		int get_param_option_count() const noexcept {
+			return static_cast<int>(m_options.size());
+		}
+
+		/*!	@brief Test if a command-line option has been set
+		*/
+		bool has_param_option(std::string_view optionName) const {
+			return findOption(optionName) != npos;
 		}
 
 		/*!	@brief Returns the option that matches the given name
 		* 
-		*	@param optionStr The **full** option name
+		*	@param optionStr The **full** option name
+		*/
+		cmdOption get_param_option(std::string_view optionStr) const {
+			auto id = findOption(optionStr);
+			if (id == npos) {
+				return {};
+			}
+
+			return get_param_option(id);
+		}
+
+		/*!	@brief Returns a copy of the option with the given id
+		* 
+		*	@param id from @c get_option_id()
+		*/
+		cmdOption get_param_option(int id) const {
+			assert((id >= 0) && (static_cast<size_t>(id) < m_options.size()));
+			auto option = m_options.get_option(static_cast<uint32_t>(id));
+			if (auto list = findList(static_cast<uint32_t>(id))) {
+				option.listConvert = list->convert;
+				option.listType = list->type;
+				option.listDelimiter = list->delimiter;
+			}
+			return option;
+		}
+
+		/*!	@brief Returns the kind of value the option holds
+		* 
+		*	@param id from @c get_option_id()
+		*/
+		optionKind get_option_kind(int id) const noexcept {
+			assert((id >= 0) && (static_cast<size_t>(id) < m_options.size()));
+			return m_options[static_cast<uint32_t>(id)].kind;
+		}
+
+		/*!	@brief Returns what happens when the option is given more than once
+		* 
+		*	@param id from @c get_option_id()
+		*/
+		repeatPolicy get_repeat_policy(int id) const noexcept {
+			assert((id >= 0) && (static_cast<size_t>(id) < m_options.size()));
+			return m_options[static_cast<uint32_t>(id)].repeat;
+		}
+
+		/*!	@brief Set the description of an option, shown in the help text
+		* 
+		*	Descriptions are kept apart from the options, so they add nothing to
+		*	the data that is used to parse the command-line.
+		* 
+		*	@return false, if there is no such option
+		*/
+		bool set_description(std::string_view optionName, std::string_view description) {
+			auto id = findOption(optionName);
+			if (id == npos) {
+				return false;
+			}
+
+			if (m_descriptions.size() <= static_cast<size_t>(id)) {
+				m_descriptions.resize(m_options.size());
+			}
+			m_descriptions[id] = m_description_text.intern(description);
+			invalidateHelp();
+			return true;
+		}
+
+		/*!	@brief Returns the description of an option, or an empty string
+		*/
+		std::string_view get_description(std::string_view optionName) const {
+			auto id = findOption(optionName);
+			return (id == npos) ? std::string_view{} : description(static_cast<uint32_t>(id));
+		}
+
+		/*!	@brief returns an overview of the options for the application
+		* 
+		*   Example, for the following options:
+		*   ```
+		*       cmd.add_param_option(cmdOption("BufferSize", "1000", 'b'));
+		*       cmd.add_param_option(cmdOption("OutputFile", "output.txt", 'o'));
+		*       cmd.set_description("BufferSize", "Size of the read buffer");
+		*   ```
+		* 
+		*   The help string should be:
+		*   ```
+		*   MyApplication.exe [options]
+		*    where options are:
+		*       -b, --BufferSize  Size of the read buffer. Default: 1000
+		*       -o, --OutputFile  Default: output.txt
+		*   ```
+		* 
+		*	Descriptions are wrapped to fit the width, in their own column. The
+		*	text is built once and kept, until an option or description is added.
+		*	It is built under a lock, so a const parser may be shared between
+		*	threads (see parseCache and cmdOverlay).
+		* 
+		*	@param width line width, or 0 for the width of the console, which
+		*	is asked for once and kept with the text
+		*/
+		std::string get_helpstring(size_t width = 0) const {
+			std::string text;
+			withHelp(width, [&](const std::string& help) { text = help; });
+			return text;
+		}
+
+		/*!	@brief Write the help text to a stream, followed by a newline
+		* 
+		*	Writes the kept text, without copying it.
+		* 
+		*	@sa get_helpstring
+		*/
+		void write_help(std::ostream& stream, size_t width = 0) const {
+			withHelp(width, [&](const std::string& help) {
+				stream.write(help.data(), static_cast<std::streamsize>(help.size()));
+			});
+			stream.put('\n');
+		}
+
+		/*!	@brief Write the help text to a C file (e.g. stdout), followed by a newline
+		* 
+		*	@sa get_helpstring
+		*/
+		void write_help(std::FILE* file, size_t width = 0) const {
+			withHelp(width, [&](const std::string& help) {
+				std::fwrite(help.data(), 1, help.size(), file);
+			});
+			std::fputc('\n', file);
+		}
+
+		/*!	@brief Write the help text to a file descriptor (e.g. STDOUT_FILENO), followed by a newline
+		* 
+		*	Writes the kept text with write(), with no stream or buffer between.
+		* 
+		*	@return false, if it could not all be written
+		* 
+		*	@sa get_helpstring
+		*/
+		bool write_help(int fd, size_t width = 0) const {
+			bool written = false;
+			withHelp(width, [&](const std::string& help) {
+				written = writeAll(fd, help);
+			});
+			return written && writeAll(fd, "\n");
+		}
+
+		/*!	@brief Returns the options whose name, short name or description contains the term
+		* 
+		*	The match ignores case. It uses an index of the three-letter sequences
+		*	(trigrams) in the text of every option, so only options that contain
+		*	every trigram of the term are compared. The index is built by the first
+		*	search, under the same lock as the help text, and kept until an option
+		*	or description is added. Once built it is not changed: a search keeps
+		*	the index it started with, so it does not hold the lock while it runs.
+		* 
+		*	@return option ids, in order of name. All options for an empty term.
+		*/
+		std::vector<uint32_t> find_options(std::string_view term) const {
+			if (term.empty()) {
+				return m_option_index;
+			}
+
+			std::shared_ptr<const searchIndex> index;
+			{
+				std::lock_guard<std::mutex> guard(m_help.lock);
+				if (!m_help.search) {
+					m_help.search = buildSearchIndex();
+				}
+				index = m_help.search;
+			}
+			const auto& search = *index;
+
+			std::string lowerTerm(term);
+			for (auto& c : lowerTerm) {
+				c = string_utils::to_lower(c);
+			}
+
+			std::vector<uint32_t> ids;
+			if (lowerTerm.size() < 3) {
+				// too short for the index
+				for (uint32_t id = 0; id < m_options.size(); id++) {
+					if (search.entry(id).find(lowerTerm) != std::string_view::npos) {
+						ids.push_back(id);
+					}
+				}
+			}
+			else {
+				// the options that contain every trigram of the term, starting with the rarest
+				std::vector<std::pair<const uint32_t*, const uint32_t*>> postings;
+				for (size_t n = 0; n + 3 <= lowerTerm.size(); n++) {
+					auto list = search.postings(searchIndex::trigram(lowerTerm.data() + n));
+					if (list.first == list.second) {
+						return {};
+					}
+					postings.push_back(list);
+				}
+				std::sort(postings.begin(), postings.end(), [](auto& a, auto& b) {
+					return (a.second - a.first) < (b.second - b.first);
+				});
+
+				ids.assign(postings[0].first, postings[0].second);
+				std::vector<uint32_t> common;
+				for (size_t n = 1; (n < postings.size()) && !ids.empty(); n++) {
+					auto list = postings[n];
+					if (ids.size() * 16 < static_cast<size_t>(list.second - list.first)) {
+						// few candidates: look each one up
+						ids.erase(std::remove_if(ids.begin(), ids.end(), [&](uint32_t id) {
+							return !std::binary_search(list.first, list.second, id);
+						}), ids.end());
+					}
+					else {
+						common.clear();
+						std::set_intersection(ids.begin(), ids.end(), list.first, list.second, std::back_inserter(common));
+						ids.swap(common);
+					}
+				}
+
+				// the trigrams may be in a different order, or apart
+				ids.erase(std::remove_if(ids.begin(), ids.end(), [&](uint32_t id) {
+					return search.entry(id).find(lowerTerm) == std::string_view::npos;
+				}), ids.end());
+			}
+
+			std::sort(ids.begin(), ids.end(), [&search](uint32_t a, uint32_t b) {
+				return search.rank[a] < search.rank[b];
+			});
+			return ids;
+		}
+
+		/*!	@brief returns the help text for the options that match the term, e.g. for --help=term
+		* 
+		*	@sa find_options, get_helpstring
+		*/
+		std::string get_helpstring(std::string_view term, size_t width = 0) const {
+			std::string text;
+			renderHelp(text, find_options(term), helpWidth(width), { " options matching \"", term, "\":\n" });
+			return text;
+		}
+
+		void write_help(std::ostream& stream, std::string_view term, size_t width = 0) const {
+			auto text = get_helpstring(term, width);
+			stream.write(text.data(), static_cast<std::streamsize>(text.size()));
+			stream.put('\n');
+		}
+
+		void write_help(std::FILE* file, std::string_view term, size_t width = 0) const {
+			auto text = get_helpstring(term, width);
+			std::fwrite(text.data(), 1, text.size(), file);
+			std::fputc('\n', file);
+		}
+
+		bool write_help(int fd, std::string_view term, size_t width = 0) const {
+			auto text = get_helpstring(term, width);
+			text += '\n';
+			return writeAll(fd, text);
+		}
+
+		bool has_errors() const {
+			return !m_errors.empty();
+		}
+
+		/*!	@brief Clears the list of errors that have accumulated
+		*/
+		void clear_errors() {
+			m_errors.clear();
+			m_error_text.clear();
+		}
+
+		/*!	@brief returns the list of errors that have accumulated, as text
+		* 
+		*   Please clear the errors after reading them.
+		* 
+		*	@sa get_error_records
+		*/
+		std::vector<std::string> get_errors() const {
+			std::vector<std::string> errors;
+			errors.reserve(m_errors.size());
+			for (auto& e : m_errors) {
+				errors.push_back(format_error(e));
+			}
+			return errors;
+		}
+
+		/*!	@brief returns the errors that have accumulated, without formatting them
+		*/
+		const std::vector<cmdError>& get_error_records() const noexcept {
+			return m_errors;
+		}
+
+		/*!	@brief Returns the text of the option name (or value) related to the error
+		*/
+		std::string_view get_error_text(const cmdError& error) const {
+			return std::string_view(m_error_text).substr(error.textOffset, error.textLength);
+		}
+
+		/*!	@brief Builds the message for an error record
+		*/
+		std::string format_error(const cmdError& error) const {
+			const auto text = get_error_text(error);
+			const std::string optionName = ((error.optionId >= 0) && (static_cast<size_t>(error.optionId) < m_options.size()))
+				? std::string(m_options.long_name(error.optionId)) : std::string();
+
+			std::string message;
+			switch (error.code) {
+			case errorCode::noArguments:
+				return "No arguments given to application";
+			case errorCode::optionExists:
+				message = "Option already exists: ";
+				break;
+			case errorCode::optionsFrozen:
+				message = "Options are frozen, unable to add: ";
+				break;
+			case errorCode::shortNameReused:
+				message = "Short option name is used more than once: ";
+				break;
+			case errorCode::lookupTableFailed:
+				return "Unable to build the option lookup table";
+			case errorCode::optionNotFound:
+				message = "Option not found: ";
+				break;
+			case errorCode::invalidListElement:
+				message = "Invalid list element: " + optionName + "[" + std::to_string(error.index) + "] at offset " + std::to_string(error.position) + ": \"";
+				message += text;
+				message += "\"";
+				return message;
+			case errorCode::missingMapKey:
+				return "Missing key for option: " + optionName;
+			case errorCode::invalidFlagValue:
+				message = "Invalid value for flag: " + optionName + " = ";
+				break;
+			case errorCode::subcommandExists:
+				message = "Subcommand already exists: ";
+				break;
+			case errorCode::subcommandNotFound:
+				message = "Subcommand not found: ";
+				break;
+			case errorCode::unexpectedArgument:
+				message = "Not an option: ";
+				break;
+			}
+
+			message += text;
+			return message;
+		}
+
+	private:
+
+		// name of the calling executable
+		std::string m_executable_name;
+
+		// argv given to init(), and the views into it
+		const char* const* m_argv{ nullptr };
+		int m_argc{ 0 };
+		std::vector<std::string_view> m_positionals;
+		listView<const char*> m_passthrough;
+
+		// the copy that init_from_string() splits, and its argv
+		std::string m_command_line;
+		std::vector<const char*> m_command_argv;
+
+		// override_options(): the split delta, and the state of each overridden option before it
+		struct overrideState
+		{
+			uint32_t count;
+			std::string value;
+		};
+		std::string m_override_text;
+		std::vector<const char*> m_override_argv;
+		std::vector<overrideState> m_override_before;
+		size_t m_unused_text{ 0 };					// bytes of m_occurrence_text that overrides replaced
+		std::vector<unsigned char> m_list_scratch;	// a list value, converted before it is stored
+
+		// see set_unknown_passthrough()
+		bool m_pass_unknown{ false };
+		std::vector<std::string_view> m_unknown_options;
+		std::vector<uint32_t> m_forward_args;		// argv indices of unknown options and positionals
+
+		// arguments : raw array given by user
+		// options   : formatted array-values supplied to app.
+		std::vector<std::string> m_arguments;
+		compactOptionTable m_options;				// in order of registration
+		std::vector<uint32_t> m_option_index;		// option ids, sorted by long name
+		std::vector<cmdError> m_errors;
+		std::string m_error_text;		// text referred to by the error records, back to back
+		int m_error_arg_index{ -1 };	// argv index of the argument being parsed
+
+		// lookup tables, built by freeze()
+		bool m_frozen{ false };
+		perfectHash m_long_hash;
+		perfectHash m_short_hash;
+		std::vector<uint32_t> m_long_slots;		// slot -> option id
+		std::vector<uint32_t> m_short_slots;	// slot -> option id
+
+		// help text, see get_helpstring(). Rarely used, so kept out of the way.
+		stringPool m_description_text;
+		std::vector<stringPool::ref> m_descriptions;	// by option id, may be shorter than the options
+
+		/*!	@brief Trigram index of the lowercased text of every option, see find_options()
+		*/
+		struct searchIndex
+		{
+			std::string text;					// long name, short name and description of each option
+			std::vector<uint32_t> offsets;		// id -> start of its text, plus the end of the last
+			std::vector<uint32_t> rank;			// id -> position in order of name
+			std::vector<uint32_t> trigrams;		// distinct trigrams, sorted
+			std::vector<uint32_t> starts;		// trigram -> start of its ids, plus the end of the last
+			std::vector<uint32_t> ids;			// ids of the options that contain each trigram, ascending
+
+			static uint32_t trigram(const char* c) noexcept {
+				return (static_cast<uint32_t>(static_cast<unsigned char>(c[0])) << 16) | (static_cast<uint32_t>(static_cast<unsigned char>(c[1])) << 8) | static_cast<unsigned char>(c[2]);
+			}
+
+			std::string_view entry(uint32_t id) const noexcept {
+				return std::string_view(text.data() + offsets[id], offsets[id + 1] - offsets[id]);
+			}
+
+			std::pair<const uint32_t*, const uint32_t*> postings(uint32_t gram) const noexcept {
+				auto it = std::lower_bound(trigrams.begin(), trigrams.end(), gram);
+				if ((it == trigrams.end()) || (*it != gram)) {
+					return { nullptr, nullptr };
+				}
+				const auto n = it - trigrams.begin();
+				return { ids.data() + starts[n], ids.data() + starts[n + 1] };
+			}
+		};
+
+		/*!	@brief Help text and search index, built on demand by const methods under their own lock
+		* 
+		*	A copy starts out empty (and with a lock of its own), so the parser
+		*	stays copyable.
+		*/
+		struct helpCache
+		{
+			std::mutex lock;
+			std::string text;
+			size_t width{ 0 };				// width the text was built for, 0 if out of date
+			size_t console{ 0 };			// width of the console, 0 until it is first needed
+			std::shared_ptr<const searchIndex> search;	// nullptr if out of date
+
+			helpCache() = default;
+			helpCache(const helpCache&) noexcept {}
+			helpCache& operator=(const helpCache&) noexcept {
+				width = 0;
+				console = 0;
+				search.reset();
+				return *this;
+			}
+		};
+
+		mutable helpCache m_help;
+
+		static constexpr int npos = -1;
+
+		/*!	@brief A subcommand, see add_subcommand()
+		*/
+		struct subcommand
+		{
+			std::string name;
+			std::function<void(basicCmdParse&)> setup;
+			uint32_t parser{ (std::numeric_limits<uint32_t>::max)() };	// in m_subcommand_parsers, once constructed
+		};
+
+		std::vector<subcommand> m_subcommands;
+		std::vector<basicCmdParse> m_subcommand_parsers;	// only for the subcommands that have been used
+		std::string m_subcommand_names;						// index keys, back to back
+		flatStringMap m_subcommand_index;					// key -> subcommand number (in valueOffset)
+		int m_active_subcommand{ npos };
+
+		std::string subcommandKey(std::string_view name) const {
+			std::string key(name);
+			if constexpr (CasePolicy::foldCase) {
+				for (auto& c : key) {
+					c = string_utils::to_lower(c);
+				}
+			}
+			return key;
+		}
+
+		/*!	@brief Make the named subcommand the active one, constructing its parser if needed
+		* 
+		*	@return the subcommand's parser, reset; or nullptr if there is no such subcommand
+		*/
+		basicCmdParse* selectSubcommand(std::string_view name) {
+			auto e = m_subcommand_index.find(m_subcommand_names, 0, subcommandKey(name));
+			if (e == nullptr) {
+				return nullptr;
+			}
+
+			auto& sub = m_subcommands[e->valueOffset];
+			if (sub.parser == (std::numeric_limits<uint32_t>::max)()) {
+				sub.parser = static_cast<uint32_t>(m_subcommand_parsers.size());
+				m_subcommand_parsers.emplace_back();
+				if (sub.setup) {
+					sub.setup(m_subcommand_parsers.back());
+				}
+			}
+
+			m_active_subcommand = static_cast<int>(e->valueOffset);
+			auto& parser = m_subcommand_parsers[sub.parser];
+			parser.reset();
+			return &parser;
+		}
+
+		/*!	@brief Inserts the option created by @c makeOption, unless the name is taken
+		*/
+		template <typename MakeOption>
+		bool emplaceOption(std::string_view optionName, MakeOption&& makeOption) {
+
+			if (m_frozen) {
+				logError(errorCode::optionsFrozen, optionName);
+				return false;
+			}
+
+			auto itF = lowerBound(optionName);
+			if ((itF != m_option_index.end()) && CasePolicy::equals(m_options.long_name(*itF), optionName)) {
+				logError(errorCode::optionExists, optionName);
+				return false;
+			}
+
+			// reserve first, so the index insert cannot fail after the option is added
+			const auto position = itF - m_option_index.begin();
+			const auto id = static_cast<uint32_t>(m_options.size());
+			if (m_option_index.size() == m_option_index.capacity()) {
+				m_option_index.reserve(m_option_index.size() * 2 + 1);
+			}
+			const cmdOption option = makeOption();
+			m_options.add(option);
+			m_option_index.insert(m_option_index.begin() + position, id);
+
+			if (option.is_list()) {
+				addList(id, option);
+			}
+			if (option.is_map()) {
+				m_map_short_length = (std::max)(m_map_short_length, static_cast<uint32_t>(option.shortName.size()));
+			}
+			invalidateHelp();
+			return true;
+		}
+
+		std::string_view description(uint32_t id) const noexcept {
+			return (id < m_descriptions.size()) ? m_description_text.view(m_descriptions[id]) : std::string_view{};
+		}
+
+		void invalidateHelp() {
+			// under the lock, as a search may be taking the index
+			std::lock_guard<std::mutex> guard(m_help.lock);
+			m_help.width = 0;
+			m_help.search.reset();
+		}
+
+		/*!	@brief Call @c fn with the help text for the width, building it if it is out of date
+		*/
+		template <typename Fn>
+		void withHelp(size_t width, Fn&& fn) const {
+			std::lock_guard<std::mutex> guard(m_help.lock);
+			if (width == 0) {
+				width = keptConsoleWidth();
+			}
+
+			if (width != m_help.width) {
+				renderHelp(m_help.text, m_option_index, width, { " where options are:\n" });
+				m_help.width = width;
+			}
+			fn(m_help.text);
+		}
+
+		std::shared_ptr<const searchIndex> buildSearchIndex() const {
+			auto built = std::make_shared<searchIndex>();
+			auto& index = *built;
+			const auto count = static_cast<uint32_t>(m_options.size());
+
+			size_t length = 0;
+			for (uint32_t id = 0; id < count; id++) {
+				const auto o = m_options[id];
+				length += o.longName.size() + o.shortName.size() + description(id).size() + 2;
+			}
+
+			index.text.clear();
+			index.text.reserve(length);
+			index.offsets.clear();
+			index.offsets.reserve(count + 1);
+
+			// every (trigram, id) pair, as trigram << 32 | id
+			std::vector<uint64_t> pairs;
+			pairs.reserve(length);
+			for (uint32_t id = 0; id < count; id++) {
+				const auto o = m_options[id];
+				const auto start = index.text.size();
+				index.offsets.push_back(static_cast<uint32_t>(start));
+				for (auto part : { std::string_view(o.longName), std::string_view(o.shortName), description(id) }) {
+					if (index.text.size() != start) {
+						index.text += '\n';
+					}
+					for (char c : part) {
+						index.text += string_utils::to_lower(c);
+					}
+				}
+
+				for (size_t n = start; n + 3 <= index.text.size(); n++) {
+					const char* c = index.text.data() + n;
+					if ((c[0] != '\n') && (c[1] != '\n') && (c[2] != '\n')) {
+						pairs.push_back((static_cast<uint64_t>(searchIndex::trigram(c)) << 32) | id);
+					}
+				}
+			}
+			index.offsets.push_back(static_cast<uint32_t>(index.text.size()));
+
+			index.rank.resize(count);
+			for (uint32_t n = 0; n < count; n++) {
+				index.rank[m_option_index[n]] = n;
+			}
+
+			std::sort(pairs.begin(), pairs.end());
+			pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+
+			index.trigrams.clear();
+			index.starts.clear();
+			index.ids.clear();
+			index.ids.reserve(pairs.size());
+			for (auto pair : pairs) {
+				const auto gram = static_cast<uint32_t>(pair >> 32);
+				if (index.trigrams.empty() || (index.trigrams.back() != gram)) {
+					index.trigrams.push_back(gram);
+					index.starts.push_back(static_cast<uint32_t>(index.ids.size()));
+				}
+				index.ids.push_back(static_cast<uint32_t>(pair));
+			}
+			index.starts.push_back(static_cast<uint32_t>(index.ids.size()));
+			return built;
+		}
+
+		/*!	@brief Returns the width, or the console width if it is 0
+		*/
+		size_t helpWidth(size_t width) const {
+			if (width != 0) {
+				return width;
+			}
+
+			std::lock_guard<std::mutex> guard(m_help.lock);
+			return keptConsoleWidth();
+		}
+
+		// the console width, asked of the console only the first time; m_help.lock is held
+		size_t keptConsoleWidth() const noexcept {
+			if (m_help.console == 0) {
+				m_help.console = consoleWidth();
+			}
+			return m_help.console;
+		}
+
+		/*!	@brief Write all of the text to a file descriptor, however many calls it takes
+		*/
+		static bool writeAll(int fd, std::string_view text) noexcept {
+			while (!text.empty()) {
+#ifdef _WIN32
+				const auto written = _write(fd, text.data(), static_cast<unsigned int>((std::min)(text.size(), static_cast<size_t>(INT_MAX))));
+#else
+				const auto written = ::write(fd, text.data(), text.size());
+				if ((written < 0) && (errno == EINTR)) {
+					continue;
+				}
+#endif
+				if (written <= 0) {
+					return false;
+				}
+				text.remove_prefix(static_cast<size_t>(written));
+			}
+			return true;
+		}
+
+		/*!	@brief Returns the width of the console, or 80 if there is no console
+		*/
+		static size_t consoleWidth() noexcept {
+			size_t width = 0;
+#ifdef _WIN32
+			CONSOLE_SCREEN_BUFFER_INFO info;
+			if (GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &info)) {
+				width = static_cast<size_t>(info.srWindow.Right - info.srWindow.Left + 1);
+			}
+#else
+			winsize size{};
+			if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == 0) {
+				width = size.ws_col;
+			}
+#endif
+			return (width == 0) ? 80 : width;
+		}
+
+		/*!	@brief Build the help text for the given options into @c text, in a single allocation
+		* 
+		*	Each option is one line of names, then its description (and default
+		*	value) in a second column, wrapped at word boundaries.
+		* 
+		*	@param title parts of the line that introduces the options
+		*/
+		void renderHelp(std::string& text, const std::vector<uint32_t>& ids, size_t width, std::initializer_list<std::string_view> title) const {
+			static constexpr std::string_view indent = "    -";
+			static constexpr std::string_view separator = ", --";
+			static constexpr std::string_view defaultLabel = "Default:";
+			static constexpr std::string_view header = " [options]\n";
+			static constexpr std::string_view footer = "\n\n(version 1.0)";
+
+			width = (std::max)(width, static_cast<size_t>(40));
+
+			size_t nameWidth = 0;
+			size_t textLength = 0;
+			for (auto id : ids) {
+				const auto o = m_options[id];
+				nameWidth = (std::max)(nameWidth, indent.size() + o.shortName.size() + separator.size() + o.longName.size());
+				textLength += description(id).size() + defaultLabel.size() + o.defaultValue.size() + 2;
+			}
+
+			// the description column starts after the longest name, but at most half way across
+			const size_t column = (std::min)(nameWidth + 2, width / 2);
+			const size_t textWidth = width - column;
+
+			// every line is at most width + 1 characters, and there are at most
+			// (text / half the column width) + 2 lines per option
+			const size_t lineCount = textLength / (textWidth / 2) + ids.size() * 3;
+			text.clear();
+			text.reserve(m_executable_name.size() + header.size() + footer.size() + lineCount * ((std::max)(width, nameWidth) + 1));
+
+			text.append(m_executable_name).append(header);
+			for (auto part : title) {
+				text.append(part);
+			}
+			for (auto id : ids) {
+				const auto o = m_options[id];
+				const auto lineStart = text.size();
+				text.append(indent).append(o.shortName).append(separator).append(o.longName);
+
+				auto about = description(id);
+				const bool showDefault = !o.is_flag() && !string_utils::is_blank(o.defaultValue);
+				if (!about.empty() || showDefault) {
+					size_t position = text.size() - lineStart;
+					if (position + 2 > column) {
+						text += '\n';
+						position = 0;
+					}
+					text.append(column - position, ' ');
+
+					position = column;
+					appendWrapped(text, about, column, width, position);
+					if (showDefault) {
+						appendWrapped(text, defaultLabel, column, width, position);
+						appendWrapped(text, o.defaultValue, column, width, position);
+					}
+				}
+				text += '\n';
+			}
+			text.append(footer);
+		}
+
+		/*!	@brief Append the words of @c words to @c text, wrapping at @c width
+		* 
+		*	@param position column of the end of the current line; updated
+		*/
+		static void appendWrapped(std::string& text, std::string_view words, size_t column, size_t width, size_t& position) {
+			size_t start = 0;
+			while (start < words.size()) {
+				if ((words[start] == ' ') || (words[start] == '\t') || (words[start] == '\n')) {
+					start++;
+					continue;
+				}
+
+				size_t end = words.find_first_of(" \t\n", start);
+				if (end == std::string_view::npos) {
+					end = words.size();
+				}
+				auto word = words.substr(start, end - start);
+				start = end;
+
+				// separate from the previous word, or start a new line
+				if (position > column) {
+					if (position + 1 + word.size() > width) {
+						text += '\n';
+						text.append(column, ' ');
+						position = column;
+					}
+					else {
+						text += ' ';
+						position++;
+					}
+				}
+
+				// split words that are longer than the column
+				while (position + word.size() > width) {
+					const auto length = width - position;
+					text.append(word.substr(0, length));
+					text += '\n';
+					text.append(column, ' ');
+					position = column;
+					word.remove_prefix(length);
+				}
+
+				text.append(word);
+				position += word.size();
+			}
+		}
+
+		/*!	@brief Converted elements of a list option
+		*/
+		struct listValues
+		{
+			uint32_t id{ 0 };
+			bool parsed{ false };
+			char delimiter{ ',' };
+			listConverter convert{ nullptr };
+			std::type_index type{ typeid(void) };
+			std::vector<unsigned char> values;		// from the command-line
+			std::vector<unsigned char> defaults;	// from the default value
+		};
+
+		std::vector<listValues> m_lists;	// sorted by option id
+
+		/*!	@brief A value of an accumulating option, see textView()
+		* 
+		*	The values of each option are linked in command-line order, so they 
+		*	are found without looking at those of other options.
+		*/
+		struct occurrence
+		{
+			uint32_t id;
+			uint32_t offset;
+			uint32_t length;
+			uint32_t next;			// index of the option's next value, or noOccurrence
+		};
+
+		struct occurrenceList
+		{
+			uint32_t first{ noOccurrence };
+			uint32_t last{ noOccurrence };
+		};
+
+		static constexpr uint32_t noOccurrence = (std::numeric_limits<uint32_t>::max)();
+
+		std::vector<uint32_t> m_occurrence_counts;	// per option id, for the last parse
+		std::vector<uint8_t> m_given;				// per option id, 1 if its count is not 0; is_flag_set() reads only this
+		std::vector<occurrence> m_occurrences;		// in command-line order
+		size_t m_unused_occurrences{ 0 };			// unlinked by overrides, their id is noOccurrence
+		std::vector<occurrenceList> m_occurrence_lists;	// per option id
+		std::string m_occurrence_text;				// values not found as they are in argv, back to back
+		flatStringMap m_map_entries;				// entries of all map options, see textView()
+
+		// Text offsets below m_argv_text are into the arguments, as if argv[1..]
+		// were back to back; the rest are into m_occurrence_text
+		std::vector<uint32_t> m_arg_starts;			// argv index -> offset of its text
+		uint32_t m_argv_text{ 0 };
+		uint32_t m_map_short_length{ 0 };			// longest short name of a map option, see findMapPrefix()
+
+		/*!	@brief Call @c fn with the parts of each argument that write_argv() writes
+		* 
+		*	@param unreadable set to the name of the first option whose value
+		*	begins or ends with a quote, which the parser would strip
+		*/
+		template <typename Fn>
+		void forEachArgument(const argvStyle& style, const char* program, std::string_view& unreadable, Fn&& fn) const {
+			fn({ (program != nullptr) ? std::string_view(program) : std::string_view(m_executable_name) });
+			forEachOption(style, unreadable, fn);
+		}
+
+		// the arguments after the program: options, positionals, "--" and the rest, then any subcommand
+		template <typename Fn>
+		void forEachOption(const argvStyle& style, std::string_view& unreadable, Fn&& fn) const {
+			static constexpr char quoteChar = SyntaxPolicy::quote;
+			const std::string_view quote(&quoteChar, 1);
+			const std::string_view separator(&style.separator, 1);
+			const std::string_view dash = style.shortNames ? "-" : "--";
+
+			auto needsQuotes = [&](std::string_view value) {
+				if ((quoteChar == '\0') || value.empty()) {
+					return false;
+				}
+				return std::isspace(static_cast<unsigned char>(value.front())) || std::isspace(static_cast<unsigned char>(value.back()));
+			};
+
+			auto check = [&](const compactOptionTable::optionView& o, std::string_view value) {
+				if ((quoteChar != '\0') && !value.empty() && ((value.front() == quoteChar) || (value.back() == quoteChar)) && unreadable.empty()) {
+					unreadable = o.longName;
+				}
+			};
+
+			for (uint32_t id = 0; id < m_options.size(); id++) {
+				const auto o = m_options[id];
+				const std::string_view name = style.shortNames ? o.shortName : o.longName;
+				const auto count = (id < m_occurrence_counts.size()) ? m_occurrence_counts[id] : 0;
+
+				auto write = [&](std::string_view value) {
+					check(o, value);
+					if (needsQuotes(value)) {
+						fn({ dash, name, separator, quote, value, quote });
+					}
+					else {
+						fn({ dash, name, separator, value });
+					}
+				};
+
+				if (o.is_flag()) {
+					for (uint32_t n = 0; n < count; n++) {
+						fn({ dash, name });
+					}
+				}
+				else if (o.is_map()) {
+					m_map_entries.for_each(id, [&](const flatStringMap::entry& e) {
+						auto key = textView(e.keyOffset, e.keyLength);
+						auto value = textView(e.valueOffset, e.valueLength);
+						check(o, value);
+						if (needsQuotes(value)) {
+							fn({ dash, name, separator, key, separator, quote, value, quote });
+						}
+						else {
+							fn({ dash, name, separator, key, separator, value });
+						}
+					});
+				}
+				else if (count == 0) {
+					if (style.allOptions) {
+						write(o.defaultValue);
+					}
+				}
+				else if (o.repeat == repeatPolicy::accumulate) {
+					forEachOccurrence(id, [&](const occurrence& occ) {
+						write(textView(occ.offset, occ.length));
+					});
+				}
+				else {
+					write(o.paramValue);
+				}
+			}
+
+			for (auto positional : m_positionals) {
+				fn({ positional });
+			}
+
+			if (m_passthrough.data != nullptr) {
+				fn({ "--" });
+				for (auto arg : m_passthrough) {
+					fn({ std::string_view(arg) });
+				}
+			}
+
+			if (auto subcommandParser = get_subcommand()) {
+				fn({ get_subcommand_name() });
+				subcommandParser->forEachOption(style, unreadable, fn);
+			}
+		}
+
+		/*!	@brief Write the parts of an argument one after another, quoted if
+		*	@c quote and it has blanks or quotes (or is empty)
+		* 
+		*	With @c escape, a quote is escaped by a backslash, and so are the
+		*	backslashes before a quote or the closing quote; other backslashes 
+		*	are literal (quoteRules::windows).
+		* 
+		*	@return the number of characters, which are only written if @c out is not nullptr
+		*/
+		static size_t joinArgument(char* out, std::initializer_list<std::string_view> parts, bool quote, bool escape) {
+			bool quoted = false;
+			if (quote) {
+				size_t length = 0;
+				for (auto part : parts) {
+					length += part.size();
+					quoted = quoted || (part.find_first_of(" \t\"") != std::string_view::npos);
+				}
+				quoted = quoted || (length == 0);
+			}
+
+			size_t n = 0;
+			auto put = [&](char c, size_t repeat = 1) {
+				if (out != nullptr) {
+					std::memset(out + n, c, repeat);
+				}
+				n += repeat;
+			};
+
+			if (!quoted) {
+				for (auto part : parts) {
+					if (out != nullptr) {
+						std::memcpy(out + n, part.data(), part.size());
+					}
+					n += part.size();
+				}
+				return n;
+			}
+
+			put('"');
+			size_t backslashes = 0;
+			for (auto part : parts) {
+				for (char c : part) {
+					if (escape && (c == '\\')) {
+						backslashes++;
+						continue;
+					}
+					if (escape && (c == '"')) {
+						put('\\', backslashes * 2 + 1);
+					}
+					else {
+						put('\\', backslashes);
+					}
+					put(c);
+					backslashes = 0;
+				}
+			}
+			put('\\', backslashes * 2);
+			put('"');
+			return n;
+		}
+
+		/*!	@brief Returns the text of a value or map key, from argv or from @c m_occurrence_text
+		*/
+		std::string_view textView(uint32_t offset, uint32_t length) const {
+			if (offset >= m_argv_text) {
+				return std::string_view(m_occurrence_text).substr(offset - m_argv_text, length);
+			}
+
+			const auto arg = std::upper_bound(m_arg_starts.begin() + 1, m_arg_starts.end(), offset) - 1;
+			return std::string_view(m_argv[arg - m_arg_starts.begin()] + (offset - *arg), length);
+		}
+
+		// textView() as a function object, for flatStringMap
+		auto textFn() const {
+			return [this](uint32_t offset, uint32_t length) { return textView(offset, length); };
+		}
+
+		bool inArgv(uint32_t offset) const noexcept {
+			return offset < m_argv_text;
+		}
+
+		/*!	@brief Returns the offset of the text, for textView()
+		* 
+		*	Text that is part of the argument @c argIndex is not copied: the 
+		*	offset refers to argv. Anything else is appended to @c m_occurrence_text.
+		* 
+		*	@param argIndex the argv index of the option's argument, or 0 if 
+		*	the text is from elsewhere (e.g. an override)
+		*/
+		uint32_t storeText(std::string_view text, int argIndex) {
+			if ((argIndex > 0) && !text.empty()) {
+				const char* arg = m_argv[argIndex];
+				const auto argLength = ((static_cast<size_t>(argIndex) + 1 < m_arg_starts.size()) ? m_arg_starts[argIndex + 1] : m_argv_text) - m_arg_starts[argIndex];
+				if ((text.data() >= arg) && (text.data() + text.size() <= arg + argLength)) {
+					return m_arg_starts[argIndex] + static_cast<uint32_t>(text.data() - arg);
+				}
+			}
+
+			const auto offset = m_argv_text + static_cast<uint32_t>(m_occurrence_text.size());
+			m_occurrence_text += text;
+			return offset;
+		}
+
+		/*!	@brief Returns the id of the map option whose short name starts @c name
+		* 
+		*	For the -DNAME=value form, where the key follows the short name directly.
+		*	Each prefix, longest first, is looked up by short name, so it takes 
+		*	no more lookups than the longest short name of a map option.
+		*/
+		int findMapPrefix(std::string_view name) const {
+			if (name.empty()) {
+				return npos;
+			}
+
+			for (auto length = (std::min)(static_cast<size_t>(m_map_short_length), name.size() - 1); length > 0; length--) {
+				const auto id = findShortOption(name.substr(0, length));
+				if ((id != npos) && m_options[id].is_map()) {
+					return id;
+				}
+			}
+
+			return npos;
+		}
+
+		const listValues* findList(uint32_t id) const {
+			auto itF = std::lower_bound(m_lists.begin(), m_lists.end(), id, [](const listValues& l, uint32_t i) { return l.id < i; });
+			return ((itF != m_lists.end()) && (itF->id == id)) ? &*itF : nullptr;
+		}
+
+		listValues* findList(uint32_t id) {
+			return const_cast<listValues*>(std::as_const(*this).findList(id));
+		}
+
+		// ids only ever increase, so appending keeps m_lists sorted
+		void addList(uint32_t id, const cmdOption& option) {
+			listValues list;
+			list.id = id;
+			list.delimiter = option.listDelimiter;
+			list.convert = option.listConvert;
+			list.type = option.listType;
+			m_lists.push_back(std::move(list));
+			convertList(id, option.defaultValue, m_lists.back().defaults);
+		}
+
+		bool convertList(uint32_t id, std::string_view value, std::vector<unsigned char>& elements) {
+			auto list = findList(id);
+			assert(list != nullptr);
+			listError error;
+			if (list->convert(value, list->delimiter, elements, error)) {
+				return true;
+			}
+
+			logError(errorCode::invalidListElement, value.substr(error.offset, error.length), static_cast<int>(id),
+				static_cast<uint32_t>(error.index), static_cast<uint32_t>(error.offset));
+			return false;
+		}
+
+		std::vector<uint32_t>::const_iterator lowerBound(std::string_view optionName) const {
+			return std::lower_bound(m_option_index.begin(), m_option_index.end(), optionName,
+				[this](uint32_t id, std::string_view name) {
+					return CasePolicy::compare(m_options.long_name(id), name) < 0;
+				});
+		}
+
+		/*!	@brief Returns the id of the option with the given (case-insensitive) long name
+		* 
+		*	@return npos if not found
+		*/
+		int findOption(std::string_view optionName) const {
+			if (m_frozen) {
+				if (m_long_hash.empty()) {
+					return npos;
+				}
+
+				const auto id = m_long_slots[m_long_hash.slot(optionName)];
+				return CasePolicy::equals(m_options.long_name(id), optionName) ? static_cast<int>(id) : npos;
+			}
+
+			auto itF = lowerBound(optionName);
+			if ((itF == m_option_index.end()) || !CasePolicy::equals(m_options.long_name(*itF), optionName)) {
+				return npos;
+			}
+
+			return static_cast<int>(*itF);
+		}
+
+		void logError(errorCode code, std::string_view text = {}, int optionId = npos, uint32_t index = 0, uint32_t position = 0) {
+			if constexpr (ErrorPolicy::enabled) {
+				cmdError error{ code, optionId, m_error_arg_index, index, position,
+					static_cast<uint32_t>(m_error_text.size()), static_cast<uint32_t>(text.size()) };
+				m_error_text += text;
+				m_errors.push_back(error);
+			}
+		};
+
+		/*!	@brief Returns the full option name of the given short name
+		* 
+		*	@return empty string if not found
+		*/
+		std::string getFullOptionName(std::string_view shortName) const {
+			auto id = findShortOption(shortName);
+			return (id == npos) ? "" : std::string(m_options.long_name(id));
+		}
+
+		/*!	@brief Returns the id of the option with the given short name
+		* 
+		*	@return npos if not found
+		*/
+		int findShortOption(std::string_view shortName) const {
+			if (m_frozen) {
+				if (m_short_hash.empty()) {
+					return npos;
+				}
+
+				const auto id = m_short_slots[m_short_hash.slot(shortName)];
+				return (m_options.short_name(id) == shortName) ? static_cast<int>(id) : npos;
+			}
+
+			return m_options.find_short(shortName);
+		}
+
+		/*!	@brief Set every flag in a combined group of short flags, e.g. -xvf or -vvv
+		* 
+		*	@return false (and sets nothing), unless every letter is the short name of a flag
+		*/
+		bool setCombinedFlags(std::string_view letters, std::vector<uint32_t>* overridden) {
+			if (letters.size() < 2) {
+				return false;
+			}
+
+			for (size_t n = 0; n < letters.size(); n++) {
+				auto id = findShortOption(letters.substr(n, 1));
+				if ((id == npos) || !m_options[id].is_flag()) {
+					return false;
+				}
+			}
+
+			for (size_t n = 0; n < letters.size(); n++) {
+				const auto id = static_cast<uint32_t>(findShortOption(letters.substr(n, 1)));
+				if (overridden != nullptr) {
+					beginOverride(id, *overridden);
+				}
+				countOccurrence(id);
+			}
+			return true;
+		}
+
+		/*!	@brief Clear what the command-line gave an option, the first time an override sets it
+		* 
+		*	The count and accumulated values start again, so the option is as if
+		*	it were only given in the override; map entries are kept, and only
+		*	the keys given are replaced. The state before is kept, to find out
+		*	afterwards whether the override changed anything.
 		*/
-		cmdOption get_param_option(std::string optionStr) {
-			auto itF = m_parameter_options.find(cmdOption(optionStr));
-			if (itF == m_parameter_options.end()) {
-				return {};
+		void beginOverride(uint32_t id, std::vector<uint32_t>& overridden) {
+			if (std::find(overridden.begin(), overridden.end(), id) != overridden.end()) {
+				return;
 			}
 
-			return *itF;
+			overridden.push_back(id);
+			m_override_before.push_back({ m_occurrence_counts[id], std::string(m_options.value(id)) });
+			m_occurrence_counts[id] = 0;
+			m_given[id] = 0;
+			if (m_options[id].repeat == repeatPolicy::accumulate) {
+				// unlink only this option's values; they are dropped when the text is compacted
+				auto& list = m_occurrence_lists[id];
+				for (auto n = list.first; n != noOccurrence; n = m_occurrences[n].next) {
+					m_occurrences[n].id = noOccurrence;
+					if (!inArgv(m_occurrences[n].offset)) {
+						m_unused_text += m_occurrences[n].length;
+					}
+					m_unused_occurrences++;
+				}
+				list = {};
+			}
 		}
 
-		/*!	@brief returns a short overview of the options for the application
-		* 
-		*   Example, for the following options:
-		*   ```
-		*       cmd.add_param_option(cmdOption("BufferSize", "1000", 'b'));
-		*       cmd.add_param_option(cmdOption("OutputFile", "output.txt", 'o'));
-		*   ```
+		/*!	@brief Copy only the text still in use to a new buffer, once most of it is not
 		* 
-		*   The help string shoudl be:
-		*   ```
-		*   MyApplication.exe [options]
-		*   where options are:
-		*			 -b, --BufferSize
-		*			 -o, --OutputFile
-		*   ```
+		*	Overrides replace accumulated values and map values, which leaves 
+		*	their old text unused; so a long run of overrides stays within twice 
+		*	the text that is in use. The occurrences they unlinked are dropped 
+		*	the same way.
 		*/
-		std::string get_helpstring() const {
-			std::string helpString = m_executable_name + " [options]\n where options are:\n";
+		void compactText() {
+			if ((m_unused_occurrences >= 64) && (m_unused_occurrences * 2 >= m_occurrences.size())) {
+				compactOccurrences();
+			}
 
-			for(auto& o : m_parameter_options) {
-				helpString += "    -" + o.shortName + ", --" + o.longName + "\n";
+			if ((m_unused_text < 1024) || (m_unused_text * 2 < m_occurrence_text.size())) {
+				return;
 			}
 
-			helpString += "\n\n(version 1.0)";
-			return helpString;
-		}
+			std::string text;
+			text.reserve(m_occurrence_text.size() - m_unused_text);
+			// text in argv stays where it is
+			auto move = [&](uint32_t& offset, uint32_t length) {
+				if (inArgv(offset)) {
+					return;
+				}
+				const auto from = offset - m_argv_text;
+				offset = m_argv_text + static_cast<uint32_t>(text.size());
+				text.append(m_occurrence_text, from, length);
+			};
+			for (auto& o : m_occurrences) {
+				if (o.id != noOccurrence) {
+					move(o.offset, o.length);
+				}
+			}
+			m_map_entries.relocate([&](flatStringMap::entry& e) {
+				move(e.keyOffset, e.keyLength);
+				move(e.valueOffset, e.valueLength);
+			});
 
-		bool has_errors() const {
-			return !m_errors.empty();
+			m_occurrence_text.swap(text);
+			m_unused_text = 0;
 		}
 
-		/*!	@brief Clears the list of errors that have accumulated
-		*/
-		void clear_errors() {
-			m_errors.clear();
+		// clear the arguments and values of the last parse
+		void clearValues() {
+			m_arguments.clear();
+			m_arg_starts.clear();
+			m_argv_text = 0;
+			m_options.clear_values();
+			m_occurrences.clear();
+			m_unused_occurrences = 0;
+			m_occurrence_text.clear();
+			m_unused_text = 0;
+			m_map_entries.clear();
+			for (auto& list : m_lists) {
+				list.parsed = false;
+				list.values.clear();
+			}
 		}
 
-		/*!	@brief returns the list of errors that have accumulated
-		* 
-		*   Please clear the errors after reading them.
-		*/
-		std::vector<std::string> get_errors() const {
-			return m_errors;
+		uint32_t countOccurrence(uint32_t id) {
+			auto& count = m_occurrence_counts[id];
+			if (count < (std::numeric_limits<uint32_t>::max)()) {
+				count++;
+			}
+			m_given[id] = 1;
+			return count;
 		}
 
-	private:
-
-		// name of the calling executable
-		std::string m_executable_name;
+		void addOccurrence(uint32_t id, uint32_t offset, uint32_t length) {
+			const auto n = static_cast<uint32_t>(m_occurrences.size());
+			m_occurrences.push_back({ id, offset, length, noOccurrence });
+			auto& list = m_occurrence_lists[id];
+			if (list.last == noOccurrence) {
+				list.first = n;
+			}
+			else {
+				m_occurrences[list.last].next = n;
+			}
+			list.last = n;
+		}
 
-		// arguments : raw array given by user
-		// options   : formatted array-values supplied to app.
-		std::vector<std::string> m_arguments;
-		std::set<cmdOption> m_parameter_options;
-		std::vector<std::string> m_errors;
+		// drop the occurrences that overrides unlinked, and renumber the links of the rest
+		void compactOccurrences() {
+			std::vector<uint32_t> remap(m_occurrences.size(), noOccurrence);
+			uint32_t next = 0;
+			for (uint32_t n = 0; n < m_occurrences.size(); n++) {
+				const auto& o = m_occurrences[n];
+				if (o.id == noOccurrence) {
+					continue;
+				}
 
-		void logError(std::string const & error) {
-			m_errors.push_back(error);
-		};
+				// only an option's own occurrences lead to its list, so no other list is touched
+				auto& list = m_occurrence_lists[o.id];
+				if (list.first == n) {
+					list.first = next;
+				}
+				if (list.last == n) {
+					list.last = next;
+				}
+				remap[n] = next;
+				m_occurrences[next++] = o;
+			}
+			m_occurrences.resize(next);
 
-		/*!	@brief Returns the full option name of the given short name
-		* 
-		*	@return empty string if not found
-		*/
-		std::string getFullOptionName(std::string shortName) {
-			for (auto& option : m_parameter_options) {
-				if(option.shortName == shortName) {
-					return option.longName;
+			for (auto& o : m_occurrences) {
+				if (o.next != noOccurrence) {
+					o.next = remap[o.next];
 				}
 			}
+			m_unused_occurrences = 0;
+		}
 
-			return "";
+		template <typename Fn>
+		void forEachOccurrence(uint32_t id, Fn&& fn) const {
+			if (id >= m_occurrence_lists.size()) {
+				return;
+			}
+			for (auto n = m_occurrence_lists[id].first; n != noOccurrence; n = m_occurrences[n].next) {
+				fn(m_occurrences[n]);
+			}
 		}
 
 
 		bool parseOptions() {
 
+			m_occurrence_counts.assign(m_options.size(), 0);
+			m_given.assign(m_options.size(), 0);
+			m_occurrence_lists.assign(m_options.size(), {});
+
+			m_positionals.clear();
+			m_passthrough = {};
+			m_unknown_options.clear();
+			m_forward_args.clear();
+
 			auto isOptionPrefix = [](const std::string& s) {
-								if (s[0] == '-') return true;
-								return false;
+								return (s.size() > 1) && (s[0] == '-');
+								};
+
+			// an argument that starts with a separator continues the option before it
+			auto isContinuation = [](const std::string& s) {
+								return !s.empty() && SyntaxPolicy::is_separator(s[0]);
 								};
 
 			auto cursor_iterator = m_arguments.begin();
 			while( cursor_iterator != m_arguments.end() )
 			{
-				// Find sections between arguments with '--' or '-'
+				// argv index of the argument (argv[0] is the executable)
+				const auto argIndex = static_cast<int>(cursor_iterator - m_arguments.begin()) + 1;
+				assert(argIndex < m_argc);
+
+				// "--" ends the options, the rest is passed through as it is
+				if (*cursor_iterator == "--") {
+					m_passthrough = { m_argv + argIndex + 1, static_cast<size_t>(m_argc - argIndex - 1) };
+					break;
+				}
+
+				if (!isOptionPrefix(*cursor_iterator)) {
+					m_positionals.emplace_back(m_argv[argIndex]);
+					if (m_pass_unknown) {
+						m_forward_args.push_back(static_cast<uint32_t>(argIndex));
+					}
+					cursor_iterator++;
+					continue;
+				}
+
+				// Find the section of the option, and any arguments that continue its value
 				//
 				// e.g. {{"--firstOption"}, {"=1234"} , {"-s"}, {"--secondOp"}}
 				//       ^------------------------------^
 				//                section
 				//
-				auto start = std::find_if(cursor_iterator, m_arguments.end(), isOptionPrefix);
-				auto end   = std::find_if(start+1, m_arguments.end(), isOptionPrefix);
-				if(start == m_arguments.end())
-					break;
+				auto start = cursor_iterator;
+				auto end   = std::find_if_not(start+1, m_arguments.end(), isContinuation);
+
+				// for error records
+				m_error_arg_index = argIndex;
+
+				// keep the arguments of an unrecognised option, see set_unknown_passthrough()
+				const auto sectionEnd = argIndex + static_cast<int>(end - start);
+				auto passUnknown = [&]() {
+					for (int n = argIndex; n < sectionEnd; n++) {
+						m_unknown_options.emplace_back(m_argv[n]);
+						m_forward_args.push_back(static_cast<uint32_t>(n));
+					}
+				};
 
 				// Combine into single param string 
 				// e.g.: "--firstOption=1234"
+				// An option in one argument is used as it is in argv, so its value is not copied
 				std::string fullOptionString;
-				for (start; start != end; start++)
-				{
-					fullOptionString += *start;
+				std::string_view section;
+				int sectionArg = 0;
+				if (end == start + 1) {
+					section = WGT::string_utils::trim_view(m_argv[argIndex]);
+					sectionArg = argIndex;
+				}
+				else {
+					for (; start != end; start++)
+					{
+						fullOptionString += *start;
+					}
+					section = fullOptionString;
 				}
 
 				// set cursor to the next section
 				cursor_iterator = end;
 
-				// Tokenize
-				assert((fullOptionString[0] == '-')); // TODO raise error if fails
-				bool useFullOptionName = (fullOptionString[0] == '-') && (fullOptionString[1] == '-');
-				WGT::string_utils::ltrim(fullOptionString, '-');
-				auto value_iterator = std::find_if(fullOptionString.begin(), fullOptionString.end(), [](const char c){ 
-																			return (c == ' ') || (c == ':') || (c == '='); }
-																			);
-
-				std::string name;
-				std::string value;
-
-				// get option name
-				for(auto it = fullOptionString.begin(); it != value_iterator; it++)
-					name += *it;
-
-				// get option value
-				for (auto it = value_iterator + 1; it != fullOptionString.end(); it++)
-					value += *it;
-
-				WGT::string_utils::trim(name);
-				WGT::string_utils::trim(value);
-				WGT::string_utils::trim(value, '\"');
-
-				// If we have been given the short name, convert it to the full name
-				if (!useFullOptionName)
-				{
-					name = getFullOptionName(name);
-					if(name.empty()) {
-						logError("Option not found: " + name);
-						return false;
+				switch (applySection(section, sectionArg, m_pass_unknown, nullptr)) {
+				case sectionResult::failed:
+					return false;
+				case sectionResult::unknown:
+					passUnknown();
+					break;
+				case sectionResult::done:
+					break;
+				}
+			}
+
+
+			return true;
+		}
+
+		// what applySection() did with an option and its value
+		enum class sectionResult : uint8_t
+		{
+			done,
+			unknown,	// not an option, and allowed to be
+			failed		// the error has been logged
+		};
+
+		/*!	@brief Apply one option and its value, e.g. "--firstOption=1234", to the option's slot
+		* 
+		*	@param sectionArg the argv index, if @c section is that argument, or 0
+		*	@param overridden for override_options(), the ids of the options 
+		*	overridden so far, or nullptr when parsing a whole command-line
+		*/
+		sectionResult applySection(std::string_view section, int sectionArg, bool allowUnknown, std::vector<uint32_t>* overridden) {
+			// Tokenize
+			assert(section[0] == '-');
+			const bool useFullOptionName = (section.size() > 1) && (section[1] == '-');
+			section.remove_prefix((std::min)(section.find_first_not_of('-'), section.size()));
+			const auto separator = std::find_if(section.begin(), section.end(), [](const char c){ 
+																		return SyntaxPolicy::is_separator(c); }
+																		) - section.begin();
+
+			// get option name and value
+			std::string_view name = WGT::string_utils::trim_view(section.substr(0, separator));
+			std::string_view value;
+			if (static_cast<size_t>(separator) < section.size()) {
+				value = WGT::string_utils::trim_view(section.substr(separator + 1));
+			}
+			if constexpr (SyntaxPolicy::quote != '\0') {
+				value = WGT::string_utils::trim_view(value, SyntaxPolicy::quote);
+			}
+
+			// If we have been given the short name, find the option by it
+			int id = npos;
+			std::string_view mapKey;
+			bool hasMapKey = false;
+			if (!useFullOptionName)
+			{
+				id = findShortOption(name);
+				if ((id == npos) && value.empty() && setCombinedFlags(name, overridden)) {
+					return sectionResult::done;
+				}
+
+				if (id == npos) {
+					// a map option's short name followed directly by the key, e.g. -DNAME=value
+					id = findMapPrefix(name);
+					if (id != npos) {
+						mapKey = name.substr(m_options.short_name(id).size());
+						hasMapKey = true;
+					}
+				}
+			}
+			else {
+				id = findOption(name);
+			}
+
+			if(id == npos) {
+				if (allowUnknown) {
+					return sectionResult::unknown;
+				}
+				logError(errorCode::optionNotFound, name);
+				return sectionResult::failed;
+			}
+
+			const auto option = m_options[id];
+
+			// check the value before anything is changed, so that an override
+			// that fails leaves the option as it was
+			bool flagValue = true;
+			if (option.is_flag()) {
+				// --flag, or --flag=yes/no
+				if (!value.empty() && !string_utils::is_boolean(value, flagValue)) {
+					logError(errorCode::invalidFlagValue, value, id);
+					return sectionResult::failed;
+				}
+			}
+			else if (option.is_map()) {
+				// -D:NAME=value or --define=NAME=value, split the value like name and value above
+				if (!hasMapKey) {
+					const auto keyEnd = std::find_if(value.begin(), value.end(), [](const char c) { return SyntaxPolicy::is_separator(c); }) - value.begin();
+					mapKey = WGT::string_utils::trim_view(value.substr(0, keyEnd));
+					value = (static_cast<size_t>(keyEnd) < value.size()) ? WGT::string_utils::trim_view(value.substr(keyEnd + 1)) : std::string_view{};
+				}
+
+				if (mapKey.empty()) {
+					logError(errorCode::missingMapKey, {}, id);
+					return sectionResult::failed;
+				}
+			}
+			else if (option.is_list()) {
+				// an override starts the count again, so its first value is always used
+				const bool restarts = (overridden != nullptr) && (std::find(overridden->begin(), overridden->end(), static_cast<uint32_t>(id)) == overridden->end());
+				const bool ignored = (option.repeat == repeatPolicy::firstWins) && !restarts && (m_occurrence_counts[id] != 0);
+				if (!ignored && !convertList(static_cast<uint32_t>(id), value, m_list_scratch)) {
+					return sectionResult::failed;
+				}
+			}
+
+			if (overridden != nullptr) {
+				beginOverride(static_cast<uint32_t>(id), *overridden);
+			}
+			const auto count = countOccurrence(static_cast<uint32_t>(id));
+
+			if (option.is_flag()) {
+				if (!flagValue) {
+					m_occurrence_counts[id] = 0;
+					m_given[id] = 0;
+				}
+				return sectionResult::done;
+			}
+
+			if ((option.repeat == repeatPolicy::firstWins) && (count > 1)) {
+				return sectionResult::done;
+			}
+
+			if (option.repeat == repeatPolicy::accumulate) {
+				addOccurrence(static_cast<uint32_t>(id), storeText(value, sectionArg), static_cast<uint32_t>(value.size()));
+			}
+
+			if (option.is_map()) {
+				flatStringMap::entry e;
+				e.owner = static_cast<uint32_t>(id);
+				e.keyLength = static_cast<uint32_t>(mapKey.size());
+				e.valueLength = static_cast<uint32_t>(value.size());
+
+				// a replaced key keeps its text, and only its old value is left unused
+				if (auto existing = m_map_entries.find(textFn(), e.owner, mapKey)) {
+					e.keyOffset = existing->keyOffset;
+					if (!inArgv(existing->valueOffset)) {
+						m_unused_text += existing->valueLength;
 					}
 				}
+				else {
+					e.keyOffset = storeText(mapKey, sectionArg);
+				}
+				e.valueOffset = storeText(value, sectionArg);
+				m_map_entries.insert(textFn(), e);
+				return sectionResult::done;
+			}
+
+			m_options.set_value(static_cast<uint32_t>(id), value);
+
+			if (option.is_list()) {
+				auto list = findList(static_cast<uint32_t>(id));
+				assert(list != nullptr);
+				list->parsed = true;
+				list->values.swap(m_list_scratch);
+			}
+
+			return sectionResult::done;
+		}
+	};
+
+	using cmdParse = basicCmdParse<>;
+
+
+	/*!	@brief Cache of parse results, for programs that parse the same command-lines over and over
+	* 
+	*	@c get() fingerprints argv with a 64-bit hash, and returns the result 
+	*	of an earlier parse of the same arguments if there is one, or else 
+	*	parses them once with a copy of the schema. Results are immutable and
+	*	shared: each holds its own copy of the arguments, so its views stay 
+	*	valid for as long as the result is held, even after it is evicted.
+	* 
+	*	The cache holds at most @c capacity results, and evicts the least 
+	*	recently used. It can be used from several threads at once: lookups 
+	*	hold a lock only for the index, and parse outside it.
+	* 
+	*	The schema is frozen first; errors in the schema (see freeze()) are 
+	*	in every result, so freeze it and deal with them before if need be.
+	* 
+	*   Example:
+	*	```cpp
+	*	static parseCache<> cache(makeSchema(), 256);
+	*	auto cmd = cache.get(argc, argv);
+	*	auto size = cmd->try_get<int>("BufferSize");
+	*	```
+	*/
+	template <typename Parser = cmdParse>
+	class parseCache
+	{
+	public:
+		explicit parseCache(Parser schema, size_t capacity = 64)
+			: m_schema(std::move(schema)), m_capacity((std::max)(capacity, size_t(1))) {
+			m_schema.freeze();
+			m_slots.reserve(m_capacity);
+			m_index.reserve(m_capacity);
+		}
+
+		parseCache(const parseCache&) = delete;
+		parseCache& operator=(const parseCache&) = delete;
+
+		/*!	@brief Returns the parse of the arguments, as by @c init(argc, argv) on a copy of the schema
+		*/
+		std::shared_ptr<const Parser> get(int argc, const char* const argv[]) {
+			const uint64_t fingerprint = hashArguments(argc, argv);
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				auto it = m_index.find(fingerprint);
+				if ((it != m_index.end()) && m_slots[it->second].result->matches(argc, argv)) {
+					auto& cached = m_slots[it->second];
+					cached.lastUse = ++m_clock;
+					m_hits++;
+					return std::shared_ptr<const Parser>(cached.result, &cached.result->parser);
+				}
+				m_misses++;
+			}
+
+			auto result = std::make_shared<entry>(m_schema, argc, argv);
+			std::lock_guard<std::mutex> lock(m_mutex);
+			insert(fingerprint, result);
+			return std::shared_ptr<const Parser>(result, &result->parser);
+		}
+
+		/*!	@brief Removes every result (results still held elsewhere are not affected)
+		*/
+		void clear() {
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_slots.clear();
+			m_index.clear();
+		}
+
+		size_t size() const {
+			std::lock_guard<std::mutex> lock(m_mutex);
+			return m_slots.size();
+		}
 
-				// Update the option with our new value
-				auto itF = m_parameter_options.find(cmdOption(name));
-				if(itF == m_parameter_options.end()) {
-					logError("Option not found: " + name);
+		size_t get_hit_count() const {
+			std::lock_guard<std::mutex> lock(m_mutex);
+			return m_hits;
+		}
+
+		size_t get_miss_count() const {
+			std::lock_guard<std::mutex> lock(m_mutex);
+			return m_misses;
+		}
+
+	private:
+		// a parse, with the copy of the arguments that it refers to
+		struct entry
+		{
+			std::string text;
+			std::vector<const char*> argv;
+			Parser parser;
+
+			entry(const Parser& schema, int argc, const char* const args[]) : parser(schema) {
+				std::vector<size_t> offsets;
+				offsets.reserve(static_cast<size_t>((std::max)(argc, 0)));
+				for (int n = 0; n < argc; n++) {
+					offsets.push_back(text.size());
+					text.append(args[n]);
+					text.push_back('\0');
+				}
+
+				argv.reserve(offsets.size() + 1);
+				for (auto offset : offsets) {
+					argv.push_back(text.data() + offset);
+				}
+				argv.push_back(nullptr);
+
+				parser.init(argc, argv.data());
+			}
+
+			// the fingerprint could collide, so check the arguments themselves
+			bool matches(int argc, const char* const args[]) const noexcept {
+				if (static_cast<size_t>((std::max)(argc, 0)) + 1 != argv.size()) {
 					return false;
 				}
+				for (int n = 0; n < argc; n++) {
+					if (std::strcmp(argv[n], args[n]) != 0) {
+						return false;
+					}
+				}
+				return true;
+			}
+		};
+
+		struct slot
+		{
+			uint64_t fingerprint{ 0 };
+			uint64_t lastUse{ 0 };
+			std::shared_ptr<entry> result;
+		};
+
+		Parser m_schema;
+		size_t m_capacity;
+
+		mutable std::mutex m_mutex;
+		std::vector<slot> m_slots;
+		std::unordered_map<uint64_t, uint32_t> m_index;	// fingerprint -> slot
+		uint64_t m_clock{ 0 };
+		size_t m_hits{ 0 };
+		size_t m_misses{ 0 };
+
+		static uint64_t hashArguments(int argc, const char* const argv[]) noexcept {
+			uint64_t h = static_cast<uint64_t>(argc);
+			for (int n = 0; n < argc; n++) {
+				h = hash_utils::hash(argv[n], h);
+			}
+			return h;
+		}
+
+		void insert(uint64_t fingerprint, std::shared_ptr<entry> result) {
+			// another thread parsed the same arguments, or the fingerprints collide
+			auto it = m_index.find(fingerprint);
+			if (it != m_index.end()) {
+				m_slots[it->second].result = std::move(result);
+				m_slots[it->second].lastUse = ++m_clock;
+				return;
+			}
+
+			uint32_t n;
+			if (m_slots.size() < m_capacity) {
+				n = static_cast<uint32_t>(m_slots.size());
+				m_slots.emplace_back();
+			}
+			else {
+				// only when full, and after a parse, so a scan is cheap enough
+				n = static_cast<uint32_t>(std::min_element(m_slots.begin(), m_slots.end(), [](const slot& a, const slot& b) {
+					return a.lastUse < b.lastUse;
+				}) - m_slots.begin());
+				m_index.erase(m_slots[n].fingerprint);
+			}
+
+			m_slots[n] = { fingerprint, ++m_clock, std::move(result) };
+			m_index.emplace(fingerprint, n);
+		}
+	};
+
+	/*!	@brief Per-request overrides on top of a shared, parsed command-line
+	* 
+	*	An overlay refers to a base parser, and holds only the values that it
+	*	overrides: the first @c InlineCount in an array inside the overlay, 
+	*	any more in a vector. Lookups of options that are not overridden fall
+	*	through to the base. So an overlay is made without copying anything, 
+	*	and without allocating for a few short values.
+	* 
+	*	The base must outlive the overlay, and must not change while it is 
+	*	used; many overlays (e.g. one per thread) can share it.
+	* 
+	*   Example:
+	*	```cpp
+	*	cmdOverlay<> request(baseCmd);
+	*	request.set_value("BufferSize", "64");
+	*	auto size = request.try_get<int>("BufferSize");	// 64
+	*	auto title = request.get_value("Title");		// from baseCmd
+	*	```
+	*/
+	template <typename Parser = cmdParse, size_t InlineCount = 8>
+	class cmdOverlay
+	{
+	public:
+		static constexpr int npos = -1;
+
+		explicit cmdOverlay(const Parser& base) noexcept : m_base(&base) {
+		}
+
+		const Parser& base() const noexcept {
+			return *m_base;
+		}
 
-				auto updatedOption = *itF;
-				updatedOption.paramValue = value;
-				m_parameter_options.erase(itF);
-				m_parameter_options.insert(updatedOption);
+		/*!	@brief Override the value of an option
+		* 
+		*	Only single-valued options can be overridden: the overlay has no way
+		*	to read a list, a map or an accumulated option. A flag takes a 
+		*	boolean (e.g. "yes"), or an empty value which sets it, as on the 
+		*	command-line.
+		* 
+		*	@return false, if the base has no such option, it holds more than one
+		*	value, or a flag's value is not a boolean
+		*/
+		bool set_value(std::string_view optionName, std::string_view value) {
+			const int id = m_base->get_option_id(optionName);
+			if (id == npos) {
+				return false;
 			}
 
+			const auto kind = m_base->get_option_kind(id);
+			if ((kind == optionKind::list) || (kind == optionKind::map) || (m_base->get_repeat_policy(id) == repeatPolicy::accumulate)) {
+				return false;
+			}
+			bool set = false;
+			if ((kind == optionKind::flag) && !value.empty() && !string_utils::is_boolean(value, set)) {
+				return false;
+			}
 
+			// a replaced value's text is left where it is, overlays are short lived
+			entry e{ id, static_cast<uint32_t>(m_text.size()), static_cast<uint32_t>(value.size()) };
+			m_text.append(value.data(), value.size());
+			if (auto existing = findEntry(id)) {
+				*existing = e;
+			}
+			else if (m_count < InlineCount) {
+				m_inline[m_count++] = e;
+			}
+			else {
+				m_spill.push_back(e);
+			}
 			return true;
 		}
+
+		/*!	@brief Remove the override of an option, so that it falls through to the base again
+		*/
+		void clear_value(std::string_view optionName) {
+			const int id = m_base->get_option_id(optionName);
+			if (auto existing = (id == npos) ? nullptr : findEntry(id)) {
+				// the last entry takes its place
+				if (m_spill.empty()) {
+					*existing = m_inline[--m_count];
+				}
+				else {
+					*existing = m_spill.back();
+					m_spill.pop_back();
+				}
+			}
+		}
+
+		bool is_overridden(std::string_view optionName) const {
+			const int id = m_base->get_option_id(optionName);
+			return (id != npos) && (findEntry(id) != nullptr);
+		}
+
+		size_t get_override_count() const noexcept {
+			return m_count + m_spill.size();
+		}
+
+		/*!	@brief Returns the overriding value, or else the base's value (or default value)
+		*/
+		std::string_view get_value(std::string_view optionName) const {
+			const int id = m_base->get_option_id(optionName);
+			if (id == npos) {
+				return {};
+			}
+
+			auto e = findEntry(id);
+			return (e != nullptr) ? std::string_view(m_text).substr(e->offset, e->length) : m_base->get_value(id);
+		}
+
+		template <typename T>
+		convResult<T> try_get(std::string_view optionName) const {
+			if (!m_base->has_param_option(optionName)) {
+				return convError::unknownOption;
+			}
+			return convertValue<T>(get_value(optionName));
+		}
+
+		bool is_flag_set(std::string_view optionName) const {
+			const int id = m_base->get_option_id(optionName);
+			if (id == npos) {
+				return false;
+			}
+
+			auto e = findEntry(id);
+			if (e == nullptr) {
+				return m_base->is_flag_set(id);
+			}
+
+			bool set = false;
+			return (e->length == 0) || (string_utils::is_boolean(std::string_view(m_text).substr(e->offset, e->length), set) && set);
+		}
+
+	private:
+		struct entry
+		{
+			int id;
+			uint32_t offset;	// of the value in m_text
+			uint32_t length;
+		};
+
+		const Parser* m_base;
+		std::array<entry, InlineCount> m_inline;
+		size_t m_count{ 0 };
+		std::vector<entry> m_spill;		// overrides after the first InlineCount
+		std::string m_text;
+
+		entry* findEntry(int id) noexcept {
+			return const_cast<entry*>(static_cast<const cmdOverlay*>(this)->findEntry(id));
+		}
+
+		const entry* findEntry(int id) const noexcept {
+			for (size_t n = 0; n < m_count; n++) {
+				if (m_inline[n].id == id) {
+					return &m_inline[n];
+				}
+			}
+			for (auto& e : m_spill) {
+				if (e.id == id) {
+					return &e;
+				}
+			}
+			return nullptr;
+		}
 	};
 }
\ No newline at end of file
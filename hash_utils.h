@@ -0,0 +1,409 @@
+/* ===============================================
+*	Hashing helpers used by the command-line parser
+*  ===============================================*/
+
+#pragma once
+#include "string_utils.h"
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <type_traits>
+#include <string_view>
+#include <vector>
+
+namespace WGT
+{
+
+	/*!
+	*	@brief common hashing routines for strings
+	*/
+	class hash_utils
+	{
+	public:
+		/*! 64-bit FNV-1a hash of the string, finished with a bit mixer
+		*
+		*	@param ignoreCase hash the lowercase form of the string, so that
+		*	strings that are equal by @c string_utils::iequals hash the same.
+		*/
+		static uint64_t hash(std::string_view str, uint64_t seed = 0, bool ignoreCase = false) noexcept
+		{
+			uint64_t h = 14695981039346656037ull ^ mix(seed);
+			if (ignoreCase) {
+				for (char c : str) {
+					h ^= static_cast<unsigned char>(string_utils::to_lower(c));
+					h *= 1099511628211ull;
+				}
+			}
+			else {
+				for (char c : str) {
+					h ^= static_cast<unsigned char>(c);
+					h *= 1099511628211ull;
+				}
+			}
+
+			return mix(h);
+		}
+
+		/*! 64-bit finalizer (from MurmurHash3), spreads every input bit over the result
+		*/
+		static uint64_t mix(uint64_t h) noexcept
+		{
+			h ^= h >> 33;
+			h *= 0xff51afd7ed558ccdull;
+			h ^= h >> 33;
+			h *= 0xc4ceb9fe1a85ec53ull;
+			h ^= h >> 33;
+			return h;
+		}
+	};
+
+
+	/*!	@brief Minimal perfect hash over a fixed set of keys
+	*
+	*	Built with the CHD (compress, hash and displace) method: keys are hashed
+	*	into small buckets, and each bucket is given a displacement pair that
+	*	moves all of its keys into free slots. Every key maps to a distinct slot
+	*	in [0, size()); any other string maps to some slot as well, so callers
+	*	must compare against the key stored for that slot.
+	*
+	*	Lookup is a single pass over the string, plus a little arithmetic.
+	*/
+	class perfectHash
+	{
+	public:
+		perfectHash() = default;
+
+		/*!	@brief Build the hash for the given (distinct) keys
+		*
+		*	@param slotKeys receives, for each slot, the index of the key placed there
+		*	@return false, if the keys are not distinct
+		*/
+		bool build(const std::vector<std::string_view>& keys, bool ignoreCase, std::vector<uint32_t>& slotKeys)
+		{
+			m_ignore_case = ignoreCase;
+			m_slot_count = static_cast<uint32_t>(keys.size());
+			m_displacements.clear();
+			slotKeys.clear();
+			if (keys.empty()) {
+				return true;
+			}
+
+			for (uint64_t seed = 0; seed < 16; seed++) {
+				m_seed = seed;
+				if (tryBuild(keys, slotKeys)) {
+					return true;
+				}
+
+				// equal keys can never be separated, so don't retry for those
+				if (hasDuplicates(keys)) {
+					break;
+				}
+			}
+
+			m_slot_count = 0;
+			m_displacements.clear();
+			slotKeys.clear();
+			return false;
+		}
+
+		/*!	@brief Returns the slot for the given key
+		*
+		*	Only meaningful if @c size() is not zero.
+		*/
+		uint32_t slot(std::string_view key) const noexcept
+		{
+			const uint64_t h = hash_utils::hash(key, m_seed, m_ignore_case);
+			return position(h, m_displacements[bucket(h)]);
+		}
+
+		uint32_t size() const noexcept
+		{
+			return m_slot_count;
+		}
+
+		bool empty() const noexcept
+		{
+			return m_slot_count == 0;
+		}
+
+	private:
+		// average number of keys per bucket
+		static constexpr uint32_t bucketLoad = 2;
+
+		struct displacement
+		{
+			uint32_t d0{ 0 };
+			uint32_t d1{ 0 };
+		};
+
+		std::vector<displacement> m_displacements;	// one per bucket
+		uint32_t m_slot_count{ 0 };
+		uint64_t m_seed{ 0 };
+		bool m_ignore_case{ false };
+
+		uint32_t bucket(uint64_t h) const noexcept
+		{
+			return static_cast<uint32_t>((h >> 32) % m_displacements.size());
+		}
+
+		uint32_t position(uint64_t h, displacement d) const noexcept
+		{
+			const uint64_t h2 = hash_utils::mix(h);
+			const uint64_t f1 = static_cast<uint32_t>(h) % m_slot_count;
+			const uint64_t f2 = static_cast<uint32_t>(h2) % m_slot_count;
+			return static_cast<uint32_t>((f1 + d.d0 * f2 + d.d1) % m_slot_count);
+		}
+
+		bool hasDuplicates(const std::vector<std::string_view>& keys) const
+		{
+			std::vector<std::string_view> sorted(keys);
+			if (m_ignore_case) {
+				std::sort(sorted.begin(), sorted.end(), [](std::string_view a, std::string_view b) { return string_utils::icompare(a, b) < 0; });
+				return std::adjacent_find(sorted.begin(), sorted.end(), [](std::string_view a, std::string_view b) { return string_utils::iequals(a, b); }) != sorted.end();
+			}
+
+			std::sort(sorted.begin(), sorted.end());
+			return std::adjacent_find(sorted.begin(), sorted.end()) != sorted.end();
+		}
+
+		bool tryBuild(const std::vector<std::string_view>& keys, std::vector<uint32_t>& slotKeys)
+		{
+			const uint32_t bucketCount = (m_slot_count + bucketLoad - 1) / bucketLoad;
+			m_displacements.assign(bucketCount, {});
+
+			std::vector<uint64_t> hashes(keys.size());
+			std::vector<std::vector<uint32_t>> buckets(bucketCount);
+			for (uint32_t n = 0; n < keys.size(); n++) {
+				hashes[n] = hash_utils::hash(keys[n], m_seed, m_ignore_case);
+				buckets[bucket(hashes[n])].push_back(n);
+			}
+
+			// place the largest buckets first, while there are plenty of free slots
+			std::vector<uint32_t> order(bucketCount);
+			std::iota(order.begin(), order.end(), 0);
+			std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+				return buckets[a].size() > buckets[b].size();
+			});
+
+			const uint32_t unused = (std::numeric_limits<uint32_t>::max)();
+			slotKeys.assign(m_slot_count, unused);
+			std::vector<uint32_t> positions;
+
+			std::vector<uint32_t> freeSlots;
+			for (auto b : order) {
+				const auto& members = buckets[b];
+				if (members.empty()) {
+					break;
+				}
+
+				// a single key can go straight into any free slot: with d0 = 0, pick d1 to land on it
+				if (members.size() == 1) {
+					if (freeSlots.empty()) {
+						for (uint32_t pos = m_slot_count; pos-- > 0; ) {
+							if (slotKeys[pos] == unused) {
+								freeSlots.push_back(pos);
+							}
+						}
+					}
+
+					const auto pos = freeSlots.back();
+					freeSlots.pop_back();
+					const auto f1 = position(hashes[members[0]], {});
+					m_displacements[b] = { 0, (pos + m_slot_count - f1) % m_slot_count };
+					slotKeys[pos] = members[0];
+					continue;
+				}
+
+				bool placed = false;
+				const uint64_t trialLimit = static_cast<uint64_t>(m_slot_count) * 32;
+				for (uint64_t trial = 0; (trial < trialLimit) && !placed; trial++) {
+					displacement d{ static_cast<uint32_t>(trial / m_slot_count), static_cast<uint32_t>(trial % m_slot_count) };
+
+					positions.clear();
+					placed = true;
+					for (auto key : members) {
+						auto pos = position(hashes[key], d);
+						if ((slotKeys[pos] != unused) || (std::find(positions.begin(), positions.end(), pos) != positions.end())) {
+							placed = false;
+							break;
+						}
+						positions.push_back(pos);
+					}
+
+					if (placed) {
+						m_displacements[b] = d;
+						for (size_t n = 0; n < members.size(); n++) {
+							slotKeys[positions[n]] = members[n];
+						}
+					}
+				}
+
+				if (!placed) {
+					return false;
+				}
+			}
+
+			return true;
+		}
+	};
+
+	/*!	@brief Open addressing hash map of string keys and values
+	*
+	*	The map does not own any text: keys and values are offset/length pairs
+	*	into text that the caller keeps, and passes to each call, either as the
+	*	buffer itself or as a function that returns the text at an offset. The
+	*	entries live in one flat array (linear probing), so there is no
+	*	allocation per entry. Each entry also records an owner id, so that
+	*	several logical maps can share one table.
+	*/
+	class flatStringMap
+	{
+	public:
+		struct entry
+		{
+			uint32_t owner{ 0 };
+			uint32_t keyOffset{ 0 };
+			uint32_t keyLength{ 0 };
+			uint32_t valueOffset{ 0 };
+			uint32_t valueLength{ 0 };
+		};
+
+		flatStringMap() = default;
+
+		/*!	@brief Add the entry, or replace the value of an entry with the same owner and key
+		*
+		*	@return true, if the key was not already present
+		*/
+		template <typename Text>
+		bool insert(const Text& text, const entry& e)
+		{
+			if ((m_count + 1) * 4 > m_slots.size() * 3) {
+				rehash(m_slots.empty() ? 16 : m_slots.size() * 2);
+			}
+
+			const auto key = textOf(text, e.keyOffset, e.keyLength);
+			const auto h = slotHash(e.owner, key);
+			const size_t mask = m_slots.size() - 1;
+			for (size_t n = h & mask; ; n = (n + 1) & mask) {
+				auto& bucket = m_slots[n];
+				if (bucket.hash == 0) {
+					bucket.hash = h;
+					bucket.value = e;
+					m_count++;
+					return true;
+				}
+
+				if ((bucket.hash == h) && (bucket.value.owner == e.owner) && (textOf(text, bucket.value.keyOffset, bucket.value.keyLength) == key)) {
+					bucket.value.valueOffset = e.valueOffset;
+					bucket.value.valueLength = e.valueLength;
+					return false;
+				}
+			}
+		}
+
+		/*!	@brief Returns the entry for the owner and key, or nullptr
+		*/
+		template <typename Text>
+		const entry* find(const Text& text, uint32_t owner, std::string_view key) const noexcept
+		{
+			if (m_count == 0) {
+				return nullptr;
+			}
+
+			const auto h = slotHash(owner, key);
+			const size_t mask = m_slots.size() - 1;
+			for (size_t n = h & mask; m_slots[n].hash != 0; n = (n + 1) & mask) {
+				auto& bucket = m_slots[n];
+				if ((bucket.hash == h) && (bucket.value.owner == owner) && (textOf(text, bucket.value.keyOffset, bucket.value.keyLength) == key)) {
+					return &bucket.value;
+				}
+			}
+
+			return nullptr;
+		}
+
+		/*!	@brief Call @c fn with every entry of the given owner, in no particular order
+		*/
+		template <typename Fn>
+		void for_each(uint32_t owner, Fn&& fn) const
+		{
+			for (auto& bucket : m_slots) {
+				if ((bucket.hash != 0) && (bucket.value.owner == owner)) {
+					fn(bucket.value);
+				}
+			}
+		}
+
+		/*!	@brief Call @c fn with every entry, of every owner, to move its text
+		*
+		*	@c fn may change the offsets of the key and value, but not the text
+		*	they refer to, nor the owner.
+		*/
+		template <typename Fn>
+		void relocate(Fn&& fn)
+		{
+			for (auto& bucket : m_slots) {
+				if (bucket.hash != 0) {
+					fn(bucket.value);
+				}
+			}
+		}
+
+		/*!	@brief Removes every entry, but keeps the table allocated
+		*/
+		void clear() noexcept
+		{
+			std::fill(m_slots.begin(), m_slots.end(), slot{});
+			m_count = 0;
+		}
+
+		size_t size() const noexcept
+		{
+			return m_count;
+		}
+
+	private:
+		struct slot
+		{
+			uint32_t hash{ 0 };		// 0 marks an empty slot
+			entry value;
+		};
+
+		std::vector<slot> m_slots;
+		size_t m_count{ 0 };
+
+		template <typename Text>
+		static std::string_view textOf(const Text& text, uint32_t offset, uint32_t length) noexcept
+		{
+			if constexpr (std::is_convertible_v<const Text&, std::string_view>) {
+				return std::string_view(text).substr(offset, length);
+			}
+			else {
+				return text(offset, length);
+			}
+		}
+
+		static uint32_t slotHash(uint32_t owner, std::string_view key) noexcept
+		{
+			const auto h = static_cast<uint32_t>(hash_utils::hash(key, owner));
+			return (h == 0) ? 1 : h;
+		}
+
+		void rehash(size_t slotCount)
+		{
+			std::vector<slot> old(slotCount);
+			old.swap(m_slots);
+
+			const size_t mask = slotCount - 1;
+			for (auto& s : old) {
+				if (s.hash == 0) continue;
+				size_t n = s.hash & mask;
+				while (m_slots[n].hash != 0) {
+					n = (n + 1) & mask;
+				}
+				m_slots[n] = s;
+			}
+		}
+	};
+}
@@ -6,10 +6,14 @@
 
 #pragma once
 #include <string>
+#include <string_view>
 #include <cassert>
 #include <algorithm>
 #include <cwctype>
+#include <cstdint>
+#ifdef _WIN32
 #include <windows.h>
+#endif
 
 namespace WGT
 {
@@ -23,6 +27,7 @@ namespace WGT
 		// Used to convert between std::string and std::wstring
 		// see: https://codingtidbit.com/2020/02/09/c17-codecvt_utf8-is-deprecated/
 
+#ifdef _WIN32
 		///<! Convert a wide Unicode string to an UTF8 string
 		static std::string wide2ascii_convert(std::wstring& wstr)
 		{
@@ -42,6 +47,87 @@ namespace WGT
 			MultiByteToWideChar(CP_UTF8, 0, &str[0], (int)str.size(), &wstrTo[0], size_needed);
 			return wstrTo;
 		}
+#else
+		// Elsewhere wchar_t holds UTF-32. Invalid input becomes U+FFFD, as with the Windows API.
+
+		///<! Convert a wide Unicode string to an UTF8 string
+		static std::string wide2ascii_convert(std::wstring& wstr)
+		{
+			std::string strTo;
+			strTo.reserve(wstr.size());
+			for (wchar_t wc : wstr) {
+				auto c = static_cast<uint32_t>(wc);
+				if ((c > 0x10FFFF) || ((c >= 0xD800) && (c <= 0xDFFF))) {
+					c = 0xFFFD;
+				}
+
+				if (c < 0x80) {
+					strTo += static_cast<char>(c);
+				}
+				else if (c < 0x800) {
+					strTo += static_cast<char>(0xC0 | (c >> 6));
+					strTo += static_cast<char>(0x80 | (c & 0x3F));
+				}
+				else if (c < 0x10000) {
+					strTo += static_cast<char>(0xE0 | (c >> 12));
+					strTo += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+					strTo += static_cast<char>(0x80 | (c & 0x3F));
+				}
+				else {
+					strTo += static_cast<char>(0xF0 | (c >> 18));
+					strTo += static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+					strTo += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+					strTo += static_cast<char>(0x80 | (c & 0x3F));
+				}
+			}
+			return strTo;
+		}
+
+		///<! Convert an UTF8 string to a wide Unicode String
+		static std::wstring ascii2wide_convert(std::string& str)
+		{
+			std::wstring wstrTo;
+			wstrTo.reserve(str.size());
+			for (size_t i = 0; i < str.size();) {
+				const auto lead = static_cast<unsigned char>(str[i]);
+				size_t length = 0;
+				uint32_t c = 0;
+				uint32_t min = 0;
+				if (lead < 0x80) {
+					length = 1;
+					c = lead;
+				}
+				else if ((lead & 0xE0) == 0xC0) {
+					length = 2;
+					c = lead & 0x1F;
+					min = 0x80;
+				}
+				else if ((lead & 0xF0) == 0xE0) {
+					length = 3;
+					c = lead & 0x0F;
+					min = 0x800;
+				}
+				else if ((lead & 0xF8) == 0xF0) {
+					length = 4;
+					c = lead & 0x07;
+					min = 0x10000;
+				}
+
+				bool valid = (length != 0) && (i + length <= str.size());
+				for (size_t n = 1; valid && (n < length); n++) {
+					const auto next = static_cast<unsigned char>(str[i + n]);
+					valid = (next & 0xC0) == 0x80;
+					c = (c << 6) | (next & 0x3F);
+				}
+				valid = valid && (c >= min) && (c <= 0x10FFFF) && ((c < 0xD800) || (c > 0xDFFF));
+
+				// an invalid sequence is replaced one byte at a time
+				wstrTo += valid ? static_cast<wchar_t>(c) : static_cast<wchar_t>(0xFFFD);
+				i += valid ? length : 1;
+			}
+			return wstrTo;
+		}
+#endif
 
 		/*! Lowercases given string
 		*/
@@ -90,7 +176,7 @@ namespace WGT
 
 		/*! left trim using given character
 		*/
-		static inline void ltrim(std::wstring& s, TCHAR c) {
+		static inline void ltrim(std::wstring& s, wchar_t c) {
 			s.erase(s.begin(), std::find_if(s.begin(), s.end(), [&c](wchar_t ch) {
 				return !(ch == c);
 				}));
@@ -110,7 +196,7 @@ namespace WGT
 				}).base(), s.end());
 		}
 
-		static inline void rtrim(std::wstring& s, TCHAR c) {
+		static inline void rtrim(std::wstring& s, wchar_t c) {
 			s.erase(std::find_if(s.rbegin(), s.rend(), [&c](wchar_t ch) {
 				return !(ch == c);
 				}).base(), s.end());
@@ -118,8 +204,8 @@ namespace WGT
 
 
 		// trim from both ends (in place)
-		static inline void trim(std::wstring& s, TCHAR c = (TCHAR)' ') {
-			if (c == (TCHAR)' ') {
+		static inline void trim(std::wstring& s, wchar_t c = L' ') {
+			if (c == L' ') {
 				ltrim(s);
 				rtrim(s);
 			}
@@ -130,7 +216,7 @@ namespace WGT
 		}
 
 		static inline void trim(std::string& s, char c = ' ') {
-			if (c == (TCHAR)' ') {
+			if (c == ' ') {
 				ltrim(s);
 
 				s.erase(std::find_if(s.rbegin(), s.rend(), [](char ch) {
@@ -149,6 +235,17 @@ namespace WGT
 		}
 
 
+		/*! Trim both ends as trim() does, but return a view rather than change the string
+		*/
+		static inline std::string_view trim_view(std::string_view s, char c = ' ') {
+			auto trimmed = [c](char ch) {
+				return (c == ' ') ? (std::isspace(static_cast<unsigned char>(ch)) != 0) : (ch == c);
+			};
+			while (!s.empty() && trimmed(s.front())) s.remove_prefix(1);
+			while (!s.empty() && trimmed(s.back())) s.remove_suffix(1);
+			return s;
+		}
+
 		/*! Test if given string has only spaces
 		*/
 		static bool is_blank(const std::wstring& s)
@@ -156,12 +253,73 @@ namespace WGT
 			return std::all_of(s.cbegin(), s.cend(), [](wchar_t c) { return std::iswspace(c); });
 		}
 
-		static bool is_blank(const std::string& s)
+		static bool is_blank(std::string_view s)
 		{
 			return std::all_of(s.cbegin(), s.cend(), [](char c) { return std::isspace(c); });
 		}
 
+		/*! Lowercase a single character without allocating
+		*/
+		static inline char to_lower(char c)
+		{
+			return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+		}
+
+		/*! Case-insensitive comparison, returns <0, 0 or >0 like @c std::string::compare
+		*
+		*	Unlike comparing the results of @c make_lower this does not allocate.
+		*/
+		static int icompare(std::string_view a, std::string_view b)
+		{
+			const size_t n = (std::min)(a.size(), b.size());
+			for (size_t i = 0; i < n; i++) {
+				const char ca = to_lower(a[i]);
+				const char cb = to_lower(b[i]);
+				if (ca != cb)
+					return (static_cast<unsigned char>(ca) < static_cast<unsigned char>(cb)) ? -1 : 1;
+			}
+
+			if (a.size() == b.size())
+				return 0;
+			return (a.size() < b.size()) ? -1 : 1;
+		}
+
+		/*! Case-insensitive equality test
+		*/
+		static bool iequals(std::string_view a, std::string_view b)
+		{
+			if (a.size() != b.size())
+				return false;
+			return icompare(a, b) == 0;
+		}
+
 		// Test given string to see if it can be converted to a boolean type
+		static bool is_boolean(std::string_view sv, bool& converted_value)
+		{
+			// trim spaces, without copying
+			while (!sv.empty() && std::isspace(static_cast<unsigned char>(sv.front()))) sv.remove_prefix(1);
+			while (!sv.empty() && std::isspace(static_cast<unsigned char>(sv.back()))) sv.remove_suffix(1);
+
+			if (sv.empty())
+				return false;
+
+			// test for positive
+			if (iequals(sv, "true") || iequals(sv, "yes") || (sv == "1"))
+			{
+				converted_value = true;
+				return true;
+			}
+
+			if (iequals(sv, "false") || iequals(sv, "no") || (sv == "0"))
+			{
+				converted_value = false;
+				return true;
+			}
+
+			// no conversion possible
+			return false;
+		}
+
 		static bool is_boolean(std::wstring_view sv, bool& converted_value)
 		{
 			if (sv.empty())